@@ -0,0 +1,79 @@
+#include "utils/stringutil.h"
+
+#include <QTest>
+
+// Compares the single pass scanner of StringUtil::parseDateTime with the
+// QDateTime::fromString cascade it falls back to, for each shape update sources use
+class StringUtilBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void scanner_data();
+    void scanner();
+    void formatCascade_data();
+    void formatCascade();
+
+private:
+    static void addInputs();
+};
+
+void StringUtilBenchmark::addInputs()
+{
+    QTest::addColumn<QString>("input");
+
+    QTest::newRow("iso") << QString("2024-05-01T10:00:00Z");
+    QTest::newRow("iso ms offset") << QString("2024-05-01T10:00:00.123+02:00");
+    QTest::newRow("iso date") << QString("2024-05-01");
+    QTest::newRow("iso space") << QString("2024-05-01 10:00:00");
+    QTest::newRow("rfc 2822") << QString("Wed, 01 May 2024 10:00:00 GMT");
+    QTest::newRow("rfc 2822 offset") << QString("1 May 2024 10:00:00 +0200");
+    QTest::newRow("slash year first") << QString("2024/05/01 10:00:00");
+    QTest::newRow("slash day first") << QString("01/05/2024 10:00:00");
+    QTest::newRow("slash month first") << QString("05/31/2024");
+    QTest::newRow("epoch") << QString("1714557600");
+    QTest::newRow("epoch ms") << QString("1714557600123");
+}
+
+void StringUtilBenchmark::scanner_data()
+{
+    addInputs();
+}
+
+void StringUtilBenchmark::scanner()
+{
+    QFETCH(QString, input);
+
+    // The scanner has to agree with the cascade wherever the cascade understands the input
+    const QDateTime expected = StringUtil::detail::parseWithFormats(input);
+    const QDateTime actual = StringUtil::parseDateTime(input);
+    QVERIFY(actual.isValid());
+    if (expected.isValid())
+        QCOMPARE(actual, expected);
+
+    QDateTime result;
+    QBENCHMARK {
+        result = StringUtil::parseDateTime(input);
+    }
+    QVERIFY(result.isValid());
+}
+
+void StringUtilBenchmark::formatCascade_data()
+{
+    addInputs();
+}
+
+void StringUtilBenchmark::formatCascade()
+{
+    QFETCH(QString, input);
+
+    QDateTime result;
+    QBENCHMARK {
+        result = StringUtil::detail::parseWithFormats(input);
+    }
+    Q_UNUSED(result);
+}
+
+QTEST_APPLESS_MAIN(StringUtilBenchmark)
+
+#include "stringutilbenchmark.moc"
@@ -3,6 +3,7 @@
 #include "managers/errormanager.h"
 #include "managers/settingsmanager.h"
 #include "managers/updatepresetmanager.h"
+#include "providers/asyncimageprovider.h"
 #include "providers/memoryimageprovider.h"
 
 #include <QGuiApplication>
@@ -104,6 +105,9 @@ int main(int argc, char *argv[])
     auto* memoryImageProvider = MemoryImageProvider::instance();
     engine.addImageProvider(MemoryImageProvider::providerName, memoryImageProvider);
 
+    auto* asyncImageProvider = AsyncImageProvider::instance();
+    engine.addImageProvider(AsyncImageProvider::providerName, asyncImageProvider);
+
     engine.loadFromModule("BarryAppLauncher", "Main");
 
     return app.exec();
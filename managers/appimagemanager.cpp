@@ -1,12 +1,13 @@
 #include "appimagemanager.h"
 #include "errormanager.h"
 #include "settingsmanager.h"
+#include "providers/asyncimageprovider.h"
 #include "providers/memoryimageprovider.h"
+#include "utils/updater/githubbatchupdater.h"
 #include "utils/updater/updaterfactory.h"
-#include "utils/stringutil.h"
 #include "utils/terminalutil.h"
 #include "utils/texteditorutil.h"
-#include "utils/versionutil.h"
+#include "utils/zsyncutil.h"
 
 #include <deque>
 #include <QGuiApplication>
@@ -17,6 +18,7 @@
 #include <QObject>
 #include <QProcess>
 #include <QRegularExpression>
+#include <QSet>
 #include <QUrl>
 
 // ----------------- Public -----------------
@@ -31,19 +33,6 @@ AppImageMetadataListModel* AppImageManager::appImageList() const
     return m_appImageList;
 }
 
-void AppImageManager::setAppImageList(const QList<AppImageMetadata*>& list)
-{
-    m_appImageList->clear();
-
-    for (auto* metadata : list) {
-        m_appImageList->addMetadata(metadata);
-    }
-
-    m_appImageList->sort();
-
-    emit appImageListChanged();
-}
-
 AppImageMetadata* AppImageManager::appImageMetadata() const {
     return m_appImageMetadata;
 }
@@ -97,40 +86,27 @@ void AppImageManager::setState(AppState value) {
 
 QFuture<void> AppImageManager::registerSelf()
 {
-    return QtConcurrent::run([=, this]() {
-        setLoadingAppImage(true);
-        try {
-            QString path = appImagePath();
-            if(!path.isEmpty())
-            {
-                AppImageUtil util(path);
-                QString integratedDesktopPath = util.integratedDesktopPath(path);
+    QString path = appImagePath();
+    if(path.isEmpty())
+    {
+        ErrorManager::instance()->reportError("Unable to find appimage: " + path);
+        return QtFuture::makeReadyVoidFuture();
+    }
 
-                // Check if not already integrated
-                if(integratedDesktopPath.isEmpty())
-                {
-                    QString newPath = util.registerAppImage();
-
-                    // If we integrated successfully, close and restart the app.
-                    if(!newPath.isEmpty())
-                    {
-                        QProcess::startDetached(newPath);
-                        QCoreApplication::quit();
-                    }
-                }
-                else
-                {
-                    ErrorManager::instance()->reportError("BarryAppLauncher is already registered in the desktop menu.");
-                }
-            }
-            else
-            {
-                ErrorManager::instance()->reportError("Unable to find appimage: " + path);
-            }
-        } catch (const std::exception &e) {
-            ErrorManager::instance()->reportError(e.what());
+    // Check if not already integrated
+    if(!AppImageUtil::integratedDesktopPath(path).isEmpty())
+    {
+        ErrorManager::instance()->reportError("BarryAppLauncher is already registered in the desktop menu.");
+        return QtFuture::makeReadyVoidFuture();
+    }
+
+    return registerAppImageAsync(path).then(this, [](const QString& newPath) {
+        // If we integrated successfully, close and restart the app.
+        if(!newPath.isEmpty())
+        {
+            QProcess::startDetached(newPath);
+            QCoreApplication::quit();
         }
-        setLoadingAppImage(false);
     });
 }
 
@@ -142,37 +118,56 @@ void AppImageManager::requestModal(ModalTypes modal, QVariant data)
 QFuture<void> AppImageManager::loadAppImageList()
 {
     auto promise = QSharedPointer<QPromise<void>>::create();
+    promise->start();
 
     QThreadPool::globalInstance()->start([this, promise]() {
+        QFuture<AppImageUtilMetadata> future;
         try {
-            auto utilList = AppImageUtil::getRegisteredList();
-            // load icons
-            MemoryImageProvider::instance()->clearImages();
-            for (const auto& app : utilList) {
-                QImage image(app.iconPath);
-                MemoryImageProvider::instance()->setImage(app.path, image);
-            }
+            // icons are decoded on demand by the async provider, so rows show up right away
+            future = AppImageUtil::getRegisteredListAsync();
+        } catch (const std::exception &e) {
+            ErrorManager::instance()->reportError(e.what());
+        }
 
-            // update appList on gui thread
-            QMetaObject::invokeMethod(QGuiApplication::instance(), [this, utilList, promise]() {
-                QList<AppImageMetadata*> appList;
-                for (const auto& app : utilList) {
-                    auto* meta = AppImageMetadata::createFromUtil(app, this);
-                    meta->setIcon(MemoryImageProvider::instance()->getUrl(app.path));
-                    appList.append(meta);
+        // stream the results into appList on gui thread as they complete
+        QMetaObject::invokeMethod(QGuiApplication::instance(), [this, future, promise]() {
+            // a newer load supersedes the one in flight, stop parsing for it
+            if (m_appImageListWatcher)
+                m_appImageListWatcher->future().cancel();
+
+            auto* watcher = new QFutureWatcher<AppImageUtilMetadata>(this);
+            m_appImageListWatcher = watcher;
+
+            // upsert against the current rows so unchanged delegates are kept
+            auto paths = QSharedPointer<QSet<QString>>::create();
+            connect(watcher, &QFutureWatcherBase::resultsReadyAt, this, [this, watcher, paths](int begin, int end) {
+                if (m_appImageListWatcher != watcher)
+                    return;
+
+                for (int i = begin; i < end; i++) {
+                    const AppImageUtilMetadata app = watcher->resultAt(i);
+                    upsertAppImage(app);
+                    paths->insert(app.path);
+                }
+            });
+            connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, paths, promise]() {
+                watcher->deleteLater();
+                if (m_appImageListWatcher != watcher) {
+                    promise->finish();
+                    return;
                 }
-                setAppImageList(appList);
-                setLoadingAppImageList(false);
-                promise->finish();
-            }, Qt::QueuedConnection);
 
-        } catch (const std::exception &e) {
-            ErrorManager::instance()->reportError(e.what());
-            QMetaObject::invokeMethod(QGuiApplication::instance(), [this, promise]() {
+                m_appImageListWatcher = nullptr;
+                // keep the current rows if the scan failed
+                if (!watcher->isCanceled())
+                    removeAppImages(*paths);
                 setLoadingAppImageList(false);
+                emit appImageListChanged();
                 promise->finish();
-            }, Qt::QueuedConnection);
-        }
+            });
+
+            watcher->setFuture(future);
+        }, Qt::QueuedConnection);
     });
 
     setLoadingAppImageList(true);
@@ -184,31 +179,45 @@ QFuture<void> AppImageManager::loadAppImageMetadata(const QUrl& url) {
 }
 
 QFuture<void> AppImageManager::loadAppImageMetadata(const QString& path) {
-    return QtConcurrent::run([=, this]() {
-        setLoadingAppImage(true);
-        AppImageUtil util(path);
-        try {
-            AppImageUtilMetadata metadata = util.metadata();
+    auto promise = QSharedPointer<QPromise<void>>::create();
+    promise->start();
+    setLoadingAppImage(true);
+
+    // The util drives the mount with signals, so it has to live on the gui thread
+    QMetaObject::invokeMethod(QGuiApplication::instance(), [this, path, promise]() {
+        auto* util = new AppImageUtil(path);
+
+        util->metadataAsync().then(QtFuture::Launch::Async, [path](AppImageUtilMetadata metadata) {
+            // Decode the icon before the util removes its mount
             if(!metadata.iconPath.isEmpty())
             {
                 QImage image(metadata.iconPath);
                 MemoryImageProvider::instance()->removeImage(path);
                 MemoryImageProvider::instance()->setImage(path, image);
             }
-            QMetaObject::invokeMethod(QGuiApplication::instance(), [=, this]() {
-                auto* appImageMetadata = AppImageMetadata::createFromUtil(metadata, this);
-                if(!metadata.iconPath.isEmpty())
-                {
-                    appImageMetadata->setIcon(MemoryImageProvider::instance()->getUrl(path));
-                }
-                setAppImageMetadata(appImageMetadata);
-            });
+            return metadata;
+        }).then(this, [this, path, util, promise](AppImageUtilMetadata metadata) {
+            auto* appImageMetadata = AppImageMetadata::createFromUtil(metadata, this);
+            if(!metadata.iconPath.isEmpty())
+            {
+                appImageMetadata->setIcon(MemoryImageProvider::instance()->getUrl(path));
+            }
+            setAppImageMetadata(appImageMetadata);
             setState(AppInfo);
-        } catch (const std::exception &e) {
+
+            util->deleteLater();
+            setLoadingAppImage(false);
+            promise->finish();
+        }).onFailed(this, [this, util, promise](const std::exception &e) {
             ErrorManager::instance()->reportError(e.what());
-        }
-        setLoadingAppImage(false);
-    });
+
+            util->deleteLater();
+            setLoadingAppImage(false);
+            promise->finish();
+        });
+    }, Qt::QueuedConnection);
+
+    return promise->future();
 }
 
 void AppImageManager::launchAppImage(const QUrl& url, const bool useTerminal)
@@ -262,20 +271,12 @@ QFuture<void> AppImageManager::registerAppImage(const QUrl& url)
 
 QFuture<void> AppImageManager::registerAppImage(const QString& path)
 {
-    return QtConcurrent::run([=, this]() {
-        setLoadingAppImage(true);
-        try {
-            AppImageUtil util(path);
-            QString newPath = util.registerAppImage();
-            if(!newPath.isEmpty())
-            {
-                loadAppImageMetadata(newPath);
-                loadAppImageList();
-            }
-        } catch (const std::exception &e) {
-            ErrorManager::instance()->reportError(e.what());
+    return registerAppImageAsync(path).then(this, [this](const QString& newPath) {
+        if(!newPath.isEmpty())
+        {
+            loadAppImageMetadata(newPath);
+            loadAppImageList();
         }
-        setLoadingAppImage(false);
     });
 }
 
@@ -370,51 +371,54 @@ void AppImageManager::checkForUpdate()
 
 void AppImageManager::checkForAllUpdates()
 {
-    loadAppImageList().then([this] {
+    loadAppImageList().then(this, [this] {
         setLoadingAppImageList(true);
 
-        auto queue = std::make_shared<std::deque<AppImageMetadata*>>(
-            m_appImageList->items().begin(),
-            m_appImageList->items().end()
-            );
-
-        const int maxConcurrent = std::max(1, SettingsManager::instance()->updateConcurrency());
-        auto running = std::make_shared<int>(0);
-        auto next = std::make_shared<std::function<void()>>();
+        // Every check is queued at once, UpdaterScheduler paces them per host
+        const QList<AppImageMetadata*> items = m_appImageList->items();
+        auto pending = std::make_shared<int>(items.count() + 1);
         QPointer<AppImageManager> self(this);
-        *next = [self, queue, running, maxConcurrent, next]() mutable {
-
-            if (!queue->empty() && *running < maxConcurrent) {
-
-                auto* metadata = queue->front();
-                queue->pop_front();
-
-                (*running)++;
-
-                self->loadMetadataUpdaterReleases(metadata, [self, running, next]() mutable {
-
-                    if (!self)
-                        return;
-
-                    (*running)--;
+        auto finished = [self, pending]() {
+            if (--(*pending) > 0 || !self)
+                return;
 
-                    QMetaObject::invokeMethod(qApp, [next]() { (*next)(); }, Qt::QueuedConnection);
-                });
+            self->setLoadingAppImageList(false);
+            self->m_appImageList->updateAllItems();
+            self->m_appImageList->sort();
+        };
 
-                QMetaObject::invokeMethod(qApp, [next]() { (*next)(); }, Qt::QueuedConnection);
+        // Apps on the GitHub presets are checked together, a GraphQL request per batch of repositories
+        auto* batch = new GithubBatchUpdater(this);
+        for (auto* metadata : items) {
+            UpdaterSettings settings = getUpdaterSettings(metadata);
+            settings.type = metadata->updateType();
+            if (GithubBatchUpdater::canBatch(settings))
+                batch->add(metadata->path(), settings);
+            else
+                loadMetadataUpdaterReleases(metadata, finished);
+        }
 
-                return;
+        connect(batch, &GithubBatchUpdater::updatesReady, this, [this, batch, finished]() {
+            const auto releases = batch->releases();
+            for (auto it = releases.cbegin(); it != releases.cend(); ++it) {
+                if (auto* metadata = m_appImageList->itemByPath(it.key()))
+                    setUpdaterReleases(metadata, it.value());
+                finished();
             }
 
-            if (queue->empty() && *running == 0) {
-                self->setLoadingAppImageList(false);
-                self->m_appImageList->updateAllItems();
-                self->m_appImageList->sort();
+            // Fall back to the rest api for repositories the batch could not answer
+            for (const auto& path : batch->failed()) {
+                if (auto* metadata = m_appImageList->itemByPath(path))
+                    loadMetadataUpdaterReleases(metadata, finished);
+                else
+                    finished();
             }
-        };
 
-        for (int i = 0; i < maxConcurrent; ++i)
-            (*next)();
+            batch->deleteLater();
+        });
+        batch->fetchUpdatesAsync();
+
+        finished();
     });
 }
 
@@ -503,24 +507,123 @@ void AppImageManager::updateAllAppImages()
 void AppImageManager::refreshDesktopFile()
 {
     setLoadingAppImage(true);
-    try {
-        if(AppImageUtil::refreshDesktopFile(m_appImageMetadata->path())) {
-            loadAppImageMetadata(m_appImageMetadata->path());
+    const QString path = m_appImageMetadata->path();
+    AppImageUtil::refreshDesktopFileAsync(path).then(this, [this, path](bool success) {
+        if (success) {
+            loadAppImageMetadata(path);
             loadAppImageList();
         }
-    } catch (const std::exception &e) {
+        setLoadingAppImage(false);
+    }).onFailed(this, [this](const std::exception &e) {
         ErrorManager::instance()->reportError(e.what());
         setLoadingAppImage(false);
-    }
-    setLoadingAppImage(false);
+    });
 }
 
 
 // ----------------- Private -----------------
 
+QFuture<QString> AppImageManager::registerAppImageAsync(const QString& path)
+{
+    auto promise = QSharedPointer<QPromise<QString>>::create();
+    promise->start();
+    setLoadingAppImage(true);
+
+    // The util drives the mount with signals, so it has to live on the gui thread
+    QMetaObject::invokeMethod(QGuiApplication::instance(), [this, path, promise]() {
+        auto* util = new AppImageUtil(path);
+
+        util->registerAppImageAsync().then(this, [this, util, promise](const QString& newPath) {
+            util->deleteLater();
+            setLoadingAppImage(false);
+            promise->addResult(newPath);
+            promise->finish();
+        }).onFailed(this, [this, util, promise](const std::exception &e) {
+            ErrorManager::instance()->reportError(e.what());
+
+            util->deleteLater();
+            setLoadingAppImage(false);
+            promise->addResult(QString());
+            promise->finish();
+        });
+    }, Qt::QueuedConnection);
+
+    return promise->future();
+}
+
+AppImageMetadata* AppImageManager::upsertAppImage(const AppImageUtilMetadata& app)
+{
+    auto* meta = m_appImageList->upsertMetadata(app);
+    AsyncImageProvider::instance()->setImageSource(app.path, app.iconPath);
+    QUrl icon = AsyncImageProvider::instance()->getUrl(app.path);
+    if (meta->icon() != icon) {
+        meta->setIcon(icon);
+        m_appImageList->updateItem(meta);
+    }
+    m_watcher->setIconPath(app.path, app.iconPath);
+    return meta;
+}
+
+void AppImageManager::removeAppImages(const QSet<QString>& retainedPaths)
+{
+    const QStringList removed = m_appImageList->retainPaths(retainedPaths);
+    for (const auto& path : removed) {
+        AsyncImageProvider::instance()->removeImage(path);
+        m_watcher->setIconPath(path, QString());
+    }
+}
+
+void AppImageManager::onAppImagesChanged(const QStringList& changed, const QStringList& removed)
+{
+    for (const auto& path : removed) {
+        if (m_appImageList->removeMetadata(path)) {
+            AsyncImageProvider::instance()->removeImage(path);
+            m_watcher->setIconPath(path, QString());
+        }
+    }
+
+    if (changed.isEmpty()) {
+        if (!removed.isEmpty())
+            emit appImageListChanged();
+        return;
+    }
+
+    // Re-index only the affected appimages, the cache makes unchanged ones cheap
+    QtConcurrent::run([changed]() {
+        QList<AppImageUtilMetadata> list;
+        for (const auto& path : changed) {
+            AppImageUtilMetadata app = AppImageUtil::getRegisteredMetadata(path);
+            if (app.path.isEmpty())
+                app.path = path;
+            list.append(app);
+        }
+        return list;
+    }).then(this, [this](const QList<AppImageUtilMetadata>& list) {
+        for (const auto& app : list) {
+            // Missing or no longer integrated
+            if (app.desktopFilePath.isEmpty()) {
+                m_appImageList->removeMetadata(app.path);
+                AsyncImageProvider::instance()->removeImage(app.path);
+                m_watcher->setIconPath(app.path, QString());
+                continue;
+            }
+            // An icon changed in place gets a new mtime, so a new url and a fresh decode
+            upsertAppImage(app);
+        }
+        emit appImageListChanged();
+    }).onFailed(this, [](const std::exception& e) {
+        ErrorManager::instance()->reportError(e.what());
+    });
+}
+
 AppImageManager::AppImageManager(QObject *parent)
-    : QObject(parent), m_appImageList(new AppImageMetadataListModel(this))
-{}
+    : QObject(parent),
+    m_appImageList(new AppImageMetadataListModel(this)),
+    m_watcher(new AppImageWatcherUtil(this))
+{
+    connect(m_watcher, &AppImageWatcherUtil::appImagesChanged, this, &AppImageManager::onAppImagesChanged);
+    m_watcher->start();
+}
 
 const QRegularExpression AppImageManager::invalidChars(R"([/\\:*?"<>|])");
 
@@ -557,8 +660,39 @@ void AppImageManager::loadMetadataUpdaterReleases(AppImageMetadata* appImageMeta
     }
 
     UpdaterSettings settings = getUpdaterSettings(metadata);
+
+    // Fall back to the update information embedded in the appimage, ie "zsync|https://..."
+    // or "gh-releases-zsync|owner|repo|tag|pattern"
+    if (metadata->updateType() == "zsync" && settings.url.isEmpty()) {
+        const QString updateInformation = ZsyncUtil::readUpdateInformation(metadata->path());
+        if (updateInformation.startsWith("zsync|")) {
+            settings.url = updateInformation.mid(6);
+        } else if (updateInformation.startsWith("gh-releases-zsync|")) {
+            resolveGithubReleasesZsync(updateInformation, [this, metadata, settings, callback](const QString& url) mutable {
+                if (!metadata || url.isEmpty()) {
+                    if (callback) callback();
+                    return;
+                }
+
+                settings.url = url;
+                fetchMetadataUpdaterReleases(metadata, settings, callback);
+            });
+            return;
+        }
+    }
+
+    fetchMetadataUpdaterReleases(metadata, settings, callback);
+}
+
+void AppImageManager::fetchMetadataUpdaterReleases(AppImageMetadata* appImageMetadata, const UpdaterSettings& settings, std::function<void()> callback)
+{
+    QPointer<AppImageMetadata> metadata = appImageMetadata;
     auto* updater = UpdaterFactory::create(metadata->updateType(), settings);
 
+    // The app shown in AppInfo jumps ahead of a running check of the whole list
+    if (updater && m_appImageMetadata && m_appImageMetadata->path() == metadata->path())
+        updater->setPriority(UpdaterScheduler::High);
+
     connect(updater, &IUpdater::updatesReady, this, [this, updater, metadata, callback]() {
         if (!metadata) {
             updater->deleteLater();
@@ -566,34 +700,90 @@ void AppImageManager::loadMetadataUpdaterReleases(AppImageMetadata* appImageMeta
             return;
         }
 
-        metadata->clearUpdaterReleases();
-        bool markedLatest = false;
-        for (const auto &r : updater->releases()) {
-            auto* releaseModel = new UpdaterReleaseModel(metadata);
-            releaseModel->setVersion(r.version);
-            releaseModel->setDate(r.date);
-            releaseModel->setDownload(r.download);
-
-            bool isNew = (metadata->updateCurrentVersion().isEmpty()
-                          || (VersionUtil::compareVersions(r.version, metadata->updateCurrentVersion()) == 1))
-                         && (metadata->updateCurrentDate().isEmpty()
-                             || (StringUtil::parseDateTime(r.date) > StringUtil::parseDateTime(metadata->updateCurrentDate())));
-            releaseModel->setIsNew(isNew);
-
-            if(isNew && !markedLatest) {
-                releaseModel->setIsSelected(true);
-                markedLatest = true;
-            }
+        setUpdaterReleases(metadata, updater->releases());
+        updater->deleteLater();
+        if (callback) callback();
+    });
 
-            metadata->addUpdaterRelease(releaseModel);
+    updater->fetchUpdatesAsync();
+}
+
+void AppImageManager::resolveGithubReleasesZsync(const QString& updateInformation, std::function<void(const QString&)> callback)
+{
+    // gh-releases-zsync|owner|repo|tag|pattern, tag is a release tag, latest, latest-pre or latest-all
+    const QStringList parts = updateInformation.split('|');
+    if (parts.size() != 5 || parts.at(1).isEmpty() || parts.at(2).isEmpty() || parts.at(4).isEmpty()) {
+        ErrorManager::instance()->reportError("Invalid update information: " + updateInformation);
+        if (callback) callback(QString());
+        return;
+    }
+
+    const QString repoUrl = QString("https://api.github.com/repos/%1/%2/releases").arg(parts.at(1), parts.at(2));
+    const QString& tag = parts.at(3);
+
+    UpdaterSettings settings;
+    settings.type = "json";
+    settings.versionField = "tag_name";
+    settings.dateField = "published_at";
+    settings.downloadField = "assets[*].browser_download_url";
+    settings.downloadPattern = "/" + QRegularExpression::wildcardToRegularExpression(
+                                   parts.at(4), QRegularExpression::UnanchoredWildcardConversion) + "$";
+
+    if (tag == "latest") {
+        settings.url = repoUrl + "/latest";
+    } else if (tag == "latest-pre" || tag == "latest-all") {
+        settings.url = repoUrl;
+        if (tag == "latest-pre")
+            settings.filters.append({ "prerelease", "^true$" });
+    } else {
+        settings.url = repoUrl + "/tags/" + QString::fromUtf8(QUrl::toPercentEncoding(tag));
+    }
+
+    auto* updater = UpdaterFactory::create(settings.type, settings);
+    connect(updater, &IUpdater::updatesReady, this, [updater, updateInformation, callback]() {
+        QString url;
+        for (const auto& release : updater->releases()) {
+            if (!release.download.isEmpty()) {
+                url = release.download;
+                break;
+            }
         }
+
+        if (url.isEmpty())
+            ErrorManager::instance()->reportError("No zsync file found for update information: " + updateInformation);
+
         updater->deleteLater();
-        if (callback) callback();
+        if (callback) callback(url);
     });
 
     updater->fetchUpdatesAsync();
 }
 
+void AppImageManager::setUpdaterReleases(AppImageMetadata* metadata, const QList<UpdaterRelease>& releases)
+{
+    metadata->clearUpdaterReleases();
+    bool markedLatest = false;
+    for (const auto &r : releases) {
+        auto* releaseModel = new UpdaterReleaseModel(metadata);
+        releaseModel->setVersion(r.version);
+        releaseModel->setDate(r.date);
+        releaseModel->setDownload(r.download);
+
+        bool isNew = (metadata->updateCurrentVersion().isEmpty()
+                      || (releaseModel->versionKey().compare(metadata->updateCurrentVersionKey()) == 1))
+                     && (metadata->updateCurrentDate().isEmpty()
+                         || (releaseModel->dateTime() > metadata->updateCurrentDateTime()));
+        releaseModel->setIsNew(isNew);
+
+        if(isNew && !markedLatest) {
+            releaseModel->setIsSelected(true);
+            markedLatest = true;
+        }
+
+        metadata->addUpdaterRelease(releaseModel);
+    }
+}
+
 QFuture<void> AppImageManager::loadMetadataUpdaterReleasesAsync(AppImageMetadata* appImage)
 {
     auto promise = QSharedPointer<QPromise<void>>::create();
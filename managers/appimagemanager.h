@@ -5,11 +5,13 @@
 
 #include "models/appimagemetadata.h"
 #include "models/appimagemetadatalistmodel.h"
+#include "utils/appimagewatcherutil.h"
 
 #include <QDir>
 #include <QObject>
 #include <QUrl>
 #include <QFuture>
+#include <QFutureWatcher>
 
 class AppImageManager : public QObject
 {
@@ -38,7 +40,6 @@ public:
     Q_ENUM(ModalTypes);
 
     AppImageMetadataListModel* appImageList() const;
-    void setAppImageList(const QList<AppImageMetadata*>& list);
 
     AppImageMetadata* appImageMetadata() const;
     void setAppImageMetadata(AppImageMetadata* value);
@@ -82,6 +83,8 @@ private:
 
     static const QRegularExpression invalidChars;
     AppImageMetadataListModel* m_appImageList = nullptr;
+    QFutureWatcher<AppImageUtilMetadata>* m_appImageListWatcher = nullptr;
+    AppImageWatcherUtil* m_watcher = nullptr;
     AppImageMetadata* m_appImageMetadata = nullptr;
     bool m_loadingAppImageList = false;
     bool m_loadingAppImage = false;
@@ -89,9 +92,16 @@ private:
     AppState m_state = AppList;
 
     QString appImagePath();
+    AppImageMetadata* upsertAppImage(const AppImageUtilMetadata& app);
+    void removeAppImages(const QSet<QString>& retainedPaths);
+    void onAppImagesChanged(const QStringList& changed, const QStringList& removed);
     UpdaterSettings getUpdaterSettings(AppImageMetadata* appImageMetadata);
+    QFuture<QString> registerAppImageAsync(const QString& path);
     void loadMetadataUpdaterReleases(AppImageMetadata* appImageMetadata, std::function<void()> callback = nullptr);
     QFuture<void> loadMetadataUpdaterReleasesAsync(AppImageMetadata* appImage);
+    void setUpdaterReleases(AppImageMetadata* metadata, const QList<UpdaterRelease>& releases);
+    void fetchMetadataUpdaterReleases(AppImageMetadata* appImageMetadata, const UpdaterSettings& settings, std::function<void()> callback);
+    void resolveGithubReleasesZsync(const QString& updateInformation, std::function<void(const QString&)> callback);
     UpdaterReleaseModel* getSelectedRelease(AppImageMetadata* metadata) const;
     QFuture<void> updateAppImageAsync(AppImageMetadata* metadata, UpdaterReleaseModel* release);
 
@@ -2,9 +2,11 @@
 #include "utils/terminalutil.h"
 #include "utils/texteditorutil.h"
 
-#include <QSettings>
+#include <utility>
+#include <QCoreApplication>
+#include <QFileInfo>
 #include <QStandardPaths>
-#include <QUrl>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonDocument>
@@ -17,51 +19,63 @@ SettingsManager* SettingsManager::instance() {
 }
 
 QUrl SettingsManager::appImageDefaultLocation() const {
-    QSettings settings;
-    QVariant v = settings.value("General/appImageDefaultLocation", m_appImageDefaultLocation.toString());
-    return QUrl(v.toString());
+    QReadLocker locker(&m_lock);
+    return m_snapshot.appImageDefaultLocation;
 }
 
 void SettingsManager::setAppImageDefaultLocation(QUrl value) {
     if (appImageDefaultLocation() == value)
         return;
-    QSettings settings;
-    settings.setValue("General/appImageDefaultLocation", value.toString());
+
+    {
+        QWriteLocker locker(&m_lock);
+        m_snapshot.appImageDefaultLocation = value;
+    }
+    writeValue("General/appImageDefaultLocation", value.toString());
     emit appImageDefaultLocationChanged(value);
 }
 
 bool SettingsManager::appListCompactView() const {
-    QSettings settings;
-    QVariant v = settings.value("General/appListCompactView", false);
-    return v.toBool();
+    QReadLocker locker(&m_lock);
+    return m_snapshot.appListCompactView;
 }
 
 void SettingsManager::setAppListCompactView(bool value) {
     if (appListCompactView() == value)
         return;
 
-    QSettings settings;
-    settings.setValue("General/appListCompactView", value);
+    {
+        QWriteLocker locker(&m_lock);
+        m_snapshot.appListCompactView = value;
+    }
+    writeValue("General/appListCompactView", value);
     emit appListCompactViewChanged(value);
 }
 
 SettingsManager::AppImageFileOperation SettingsManager::appImageFileOperation() const {
-    QSettings settings;
-    return static_cast<AppImageFileOperation>(settings.value("General/appImageFileOperation", static_cast<int>(AppImageFileOperation::Move)).value<int>());
+    QReadLocker locker(&m_lock);
+    return m_snapshot.appImageFileOperation;
 }
 
 void SettingsManager::setAppImageFileOperation(AppImageFileOperation value) {
     if (appImageFileOperation() == value)
         return;
-    QSettings settings;
-    settings.setValue("General/appImageFileOperation", static_cast<int>(value));
+
+    {
+        QWriteLocker locker(&m_lock);
+        m_snapshot.appImageFileOperation = value;
+    }
+    writeValue("General/appImageFileOperation", static_cast<int>(value));
     emit appImageFileOperationChanged(value);
 }
 
 QString SettingsManager::terminal() const {
-    QSettings settings;
-    QVariant v = settings.value("General/terminal", m_terminalDefault);
-    return v.toString().isEmpty() ? m_terminalDefault : v.toString();
+    QString value;
+    {
+        QReadLocker locker(&m_lock);
+        value = m_snapshot.terminal;
+    }
+    return value.isEmpty() ? m_terminalDefault.result() : value;
 }
 
 void SettingsManager::setTerminal(QString value) {
@@ -69,17 +83,23 @@ void SettingsManager::setTerminal(QString value) {
         return;
 
     if(value.isEmpty())
-        value = m_terminalDefault;
+        value = m_terminalDefault.result();
 
-    QSettings settings;
-    settings.setValue("General/terminal", value);
+    {
+        QWriteLocker locker(&m_lock);
+        m_snapshot.terminal = value;
+    }
+    writeValue("General/terminal", value);
     emit terminalChanged(value);
 }
 
 QString SettingsManager::textEditor() const {
-    QSettings settings;
-    QVariant v = settings.value("General/textEditor", m_textEditorDefault);
-    return v.toString().isEmpty() ? m_textEditorDefault : v.toString();
+    QString value;
+    {
+        QReadLocker locker(&m_lock);
+        value = m_snapshot.textEditor;
+    }
+    return value.isEmpty() ? m_textEditorDefault.result() : value;
 }
 
 void SettingsManager::setTextEditor(QString value) {
@@ -87,40 +107,47 @@ void SettingsManager::setTextEditor(QString value) {
         return;
 
     if(value.isEmpty())
-        value = m_textEditorDefault;
+        value = m_textEditorDefault.result();
 
-    QSettings settings;
-    settings.setValue("General/textEditor", value);
+    {
+        QWriteLocker locker(&m_lock);
+        m_snapshot.textEditor = value;
+    }
+    writeValue("General/textEditor", value);
     emit textEditorChanged(value);
 }
 
 bool SettingsManager::keepBackup() const {
-    QSettings settings;
-    QVariant v = settings.value("General/keepBackup", false);
-    return v.toBool();
+    QReadLocker locker(&m_lock);
+    return m_snapshot.keepBackup;
 }
 
 void SettingsManager::setKeepBackup(bool value) {
     if (keepBackup() == value)
         return;
 
-    QSettings settings;
-    settings.setValue("General/keepBackup", value);
+    {
+        QWriteLocker locker(&m_lock);
+        m_snapshot.keepBackup = value;
+    }
+    writeValue("General/keepBackup", value);
     emit keepBackupChanged(value);
 }
 
 int SettingsManager::updateConcurrency() const {
-    QSettings settings;
-    QVariant v = settings.value("General/updateConcurrency", 3);
-    return v.toInt();
+    QReadLocker locker(&m_lock);
+    return m_snapshot.updateConcurrency;
 }
 
 void SettingsManager::setUpdateConcurrency(int value) {
     if (updateConcurrency() == value)
         return;
 
-    QSettings settings;
-    settings.setValue("General/updateConcurrency", value);
+    {
+        QWriteLocker locker(&m_lock);
+        m_snapshot.updateConcurrency = value;
+    }
+    writeValue("General/updateConcurrency", value);
     emit updateConcurrencyChanged(value);
 }
 
@@ -135,8 +162,15 @@ bool SettingsManager::textEditorExists(const QString& path)
 }
 
 void SettingsManager::saveUpdateHeadersJson(const QJsonArray &headers) {
+    const QList<UpdateHeader> list = parseUpdateHeaders(headers);
+    {
+        QWriteLocker locker(&m_lock);
+        m_snapshot.updateHeadersJson = headers;
+        m_snapshot.updateHeaders = list;
+    }
+
     QJsonDocument doc(headers);
-    QSettings().setValue("Update/headers", QString::fromUtf8(doc.toJson(QJsonDocument::Compact)));
+    writeValue("Update/headers", QString::fromUtf8(doc.toJson(QJsonDocument::Compact)));
 }
 
 void SettingsManager::saveUpdateHeaders(const QList<UpdateHeader> &headers) {
@@ -152,31 +186,167 @@ void SettingsManager::saveUpdateHeaders(const QList<UpdateHeader> &headers) {
 }
 
 QJsonArray SettingsManager::getUpdateHeadersJson() const {
-    QString json = QSettings().value("Update/headers", "[]").toString();
-    QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8());
-    return doc.isArray() ? doc.array() : QJsonArray();
+    QReadLocker locker(&m_lock);
+    return m_snapshot.updateHeadersJson;
 }
 
 QList<UpdateHeader> SettingsManager::getUpdateHeaders() const {
-    QList<UpdateHeader> list;
-    for (const auto &v : getUpdateHeadersJson()) {
-        QJsonObject obj = v.toObject();
-        list.append(UpdateHeader{
-            obj["website"].toString(),
-            obj["header"].toString(),
-            obj["value"].toString()
-        });
+    QReadLocker locker(&m_lock);
+    return m_snapshot.updateHeaders;
+}
+
+void SettingsManager::sync() {
+    QHash<QString, QVariant> pending;
+    {
+        QWriteLocker locker(&m_lock);
+        pending.swap(m_pending);
     }
-    return list;
+
+    // An outside edit this sync merges still has to reach the snapshot through reload()
+    const bool changed = configFileChanged();
+
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it)
+        m_settings.setValue(it.key(), it.value());
+    m_settings.sync();
+
+    if (!changed)
+        rememberConfigFile();
 }
 
 // ----------------- Private -----------------
 
 const QUrl SettingsManager::m_appImageDefaultLocation = QUrl::fromLocalFile(QStandardPaths::writableLocation(QStandardPaths::HomeLocation) + "/Applications");
-const QString SettingsManager::m_terminalDefault = TerminalUtil::detectTerminal();
-const QString SettingsManager::m_textEditorDefault = TextEditorUtil::detectTextEditor();
+const int SettingsManager::syncInterval = 500;
+const int SettingsManager::reloadInterval = 200;
 
 
 SettingsManager::SettingsManager(QObject *parent)
     : QObject{parent}
-{}
+{
+    rememberConfigFile();
+
+    // Both walk $PATH and the editor one runs xdg-mime, keep them off the startup path
+    m_terminalDefault = QtConcurrent::run([]() -> QString { return TerminalUtil::detectTerminal(); });
+    m_textEditorDefault = QtConcurrent::run([]() -> QString { return TextEditorUtil::detectTextEditor(); });
+
+    m_snapshot = readSnapshot();
+
+    // Setters only touch the snapshot, writes are batched
+    m_syncTimer.setSingleShot(true);
+    m_syncTimer.setInterval(syncInterval);
+    connect(&m_syncTimer, &QTimer::timeout, this, &SettingsManager::sync);
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this]() {
+        m_syncTimer.stop();
+        m_reloadTimer.stop();
+        sync();
+    });
+
+    // Edits made outside the app, and the rename QSettings does on save
+    m_reloadTimer.setSingleShot(true);
+    m_reloadTimer.setInterval(reloadInterval);
+    connect(&m_reloadTimer, &QTimer::timeout, this, &SettingsManager::reload);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, [this]() {
+        watchConfigFile();
+        m_reloadTimer.start();
+    });
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() {
+        watchConfigFile();
+        m_reloadTimer.start();
+    });
+    watchConfigFile();
+}
+
+void SettingsManager::writeValue(const QString& key, const QVariant& value) {
+    {
+        QWriteLocker locker(&m_lock);
+        m_pending.insert(key, value);
+    }
+
+    QMetaObject::invokeMethod(this, [this]() {
+        if (!m_syncTimer.isActive())
+            m_syncTimer.start();
+    });
+}
+
+void SettingsManager::reload() {
+    // The file is as our last sync left it, the event came from that write
+    if (!configFileChanged())
+        return;
+
+    // Pending writes go first, QSettings then rereads the file if it changed
+    sync();
+    const Snapshot next = readSnapshot();
+    rememberConfigFile();
+
+    Snapshot previous;
+    {
+        QWriteLocker locker(&m_lock);
+        previous = std::exchange(m_snapshot, next);
+    }
+
+    if (previous.appImageDefaultLocation != next.appImageDefaultLocation)
+        emit appImageDefaultLocationChanged(next.appImageDefaultLocation);
+    if (previous.appListCompactView != next.appListCompactView)
+        emit appListCompactViewChanged(next.appListCompactView);
+    if (previous.appImageFileOperation != next.appImageFileOperation)
+        emit appImageFileOperationChanged(next.appImageFileOperation);
+    if (previous.terminal != next.terminal)
+        emit terminalChanged(terminal());
+    if (previous.textEditor != next.textEditor)
+        emit textEditorChanged(textEditor());
+    if (previous.keepBackup != next.keepBackup)
+        emit keepBackupChanged(next.keepBackup);
+    if (previous.updateConcurrency != next.updateConcurrency)
+        emit updateConcurrencyChanged(next.updateConcurrency);
+}
+
+void SettingsManager::watchConfigFile() {
+    const QString path = m_settings.fileName();
+    const QString dir = QFileInfo(path).absolutePath();
+
+    if (QFileInfo::exists(path) && !m_watcher.files().contains(path))
+        m_watcher.addPath(path);
+    if (QFileInfo::exists(dir) && !m_watcher.directories().contains(dir))
+        m_watcher.addPath(dir);
+}
+
+bool SettingsManager::configFileChanged() const {
+    const QFileInfo info(m_settings.fileName());
+    return info.lastModified() != m_syncedModified || info.size() != m_syncedSize;
+}
+
+void SettingsManager::rememberConfigFile() {
+    const QFileInfo info(m_settings.fileName());
+    m_syncedModified = info.lastModified();
+    m_syncedSize = info.size();
+}
+
+const SettingsManager::Snapshot SettingsManager::readSnapshot() {
+    Snapshot snapshot;
+    snapshot.appImageDefaultLocation = QUrl(m_settings.value("General/appImageDefaultLocation", m_appImageDefaultLocation.toString()).toString());
+    snapshot.appListCompactView = m_settings.value("General/appListCompactView", false).toBool();
+    snapshot.appImageFileOperation = static_cast<AppImageFileOperation>(m_settings.value("General/appImageFileOperation", static_cast<int>(AppImageFileOperation::Move)).value<int>());
+    snapshot.terminal = m_settings.value("General/terminal").toString();
+    snapshot.textEditor = m_settings.value("General/textEditor").toString();
+    snapshot.keepBackup = m_settings.value("General/keepBackup", false).toBool();
+    snapshot.updateConcurrency = m_settings.value("General/updateConcurrency", 3).toInt();
+
+    QJsonDocument doc = QJsonDocument::fromJson(m_settings.value("Update/headers", "[]").toString().toUtf8());
+    snapshot.updateHeadersJson = doc.isArray() ? doc.array() : QJsonArray();
+    snapshot.updateHeaders = parseUpdateHeaders(snapshot.updateHeadersJson);
+
+    return snapshot;
+}
+
+const QList<UpdateHeader> SettingsManager::parseUpdateHeaders(const QJsonArray &headers) {
+    QList<UpdateHeader> list;
+    for (const auto &v : headers) {
+        QJsonObject obj = v.toObject();
+        list.append(UpdateHeader{
+            obj["website"].toString(),
+            obj["header"].toString(),
+            obj["value"].toString()
+        });
+    }
+    return list;
+}
@@ -3,10 +3,19 @@
 
 #pragma once
 
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QFuture>
+#include <QHash>
 #include <QObject>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonDocument>
+#include <QReadWriteLock>
+#include <QSettings>
+#include <QTimer>
+#include <QUrl>
+#include <QVariant>
 
 struct UpdateHeader {
 public:
@@ -65,12 +74,52 @@ public:
     Q_INVOKABLE QJsonArray getUpdateHeadersJson() const;
     QList<UpdateHeader> getUpdateHeaders() const;
 
+    /**
+     * @brief Writes pending changes to the config file right away
+     */
+    void sync();
+
 private:
     explicit SettingsManager(QObject *parent = nullptr);
 
+    // Typed copy of the config file, read by the getters from any thread
+    struct Snapshot {
+        QUrl appImageDefaultLocation;
+        bool appListCompactView = false;
+        AppImageFileOperation appImageFileOperation = Move;
+        QString terminal;
+        QString textEditor;
+        bool keepBackup = false;
+        int updateConcurrency = 3;
+        QJsonArray updateHeadersJson;
+        QList<UpdateHeader> updateHeaders;
+    };
+
     static const QUrl m_appImageDefaultLocation;
-    static const QString m_terminalDefault;
-    static const QString m_textEditorDefault;
+    static const int syncInterval;
+    static const int reloadInterval;
+
+    mutable QReadWriteLock m_lock;
+    Snapshot m_snapshot;
+    QHash<QString, QVariant> m_pending;
+    QSettings m_settings;
+    QFileSystemWatcher m_watcher;
+    QTimer m_syncTimer;
+    QTimer m_reloadTimer;
+    QDateTime m_syncedModified;
+    qint64 m_syncedSize = -1;
+    // Detected on the thread pool, getters only wait if asked before it is done
+    QFuture<QString> m_terminalDefault;
+    QFuture<QString> m_textEditorDefault;
+
+    void writeValue(const QString& key, const QVariant& value);
+    void reload();
+    void watchConfigFile();
+    bool configFileChanged() const;
+    void rememberConfigFile();
+    const Snapshot readSnapshot();
+
+    static const QList<UpdateHeader> parseUpdateHeaders(const QJsonArray &headers);
 
 signals:
     void appImageDefaultLocationChanged(QUrl newValue);
@@ -1,4 +1,5 @@
 #include "appimagemetadata.h"
+#include "utils/stringutil.h"
 
 // ----------------- Public -----------------
 
@@ -13,6 +14,21 @@ AppImageMetadata* AppImageMetadata::createFromUtil(
     QObject* parent)
 {
     auto* metadata = new AppImageMetadata(parent);
+    metadata->updateFromUtil(util);
+    metadata->setUpdateDirty(false);
+
+    return metadata;
+}
+
+bool AppImageMetadata::updateFromUtil(const AppImageUtilMetadata& util)
+{
+    // Another version on disk makes the fetched releases and the last update result stale
+    const bool installedChanged = m_version != util.version
+                                  || (!m_updateDirty
+                                      && (m_updateCurrentVersion != util.updateCurrentVersion
+                                          || m_updateCurrentDate != util.updateCurrentDate));
+    if (installedChanged)
+        resetUpdateState();
 
     AppImageMetadata::IntegrationType integration =
         util.desktopFilePath.isEmpty()
@@ -21,33 +37,48 @@ AppImageMetadata* AppImageMetadata::createFromUtil(
                    ? AppImageMetadata::IntegrationType::Internal
                    : AppImageMetadata::IntegrationType::External);
 
-    metadata->setName(util.name);
-    metadata->setVersion(util.version);
-    metadata->setComment(util.comment);
-    metadata->setType(util.type);
-    metadata->setChecksum(util.checksum);
-    metadata->setCategories(util.categories);
-    metadata->setPath(util.path);
-    metadata->setIntegration(integration);
-    metadata->setDesktopFilePath(util.desktopFilePath);
-    metadata->setExecutable(util.executable);
-    metadata->setUpdateType(util.updateType);
-    metadata->setUpdateUrl(util.updateUrl);
-    metadata->setUpdateDownloadField(util.updateDownloadField);
-    metadata->setUpdateDownloadPattern(util.updateDownloadPattern);
-    metadata->setUpdateDateField(util.updateDateField);
-    metadata->setUpdateVersionField(util.updateVersionField);
-    metadata->setUpdateVersionPattern(util.updateVersionPattern);
-    metadata->setUpdateCurrentDate(util.updateCurrentDate);
-    metadata->setUpdateCurrentVersion(util.updateCurrentVersion);
-
-    for (const auto& filter : util.updateFilters) {
-        metadata->addUpdateFilter(UpdaterFilterModel::createFromUtil(filter, metadata));
+    setName(util.name);
+    setVersion(util.version);
+    setComment(util.comment);
+    setType(util.type);
+    setChecksum(util.checksum);
+    setCategories(util.categories);
+    setPath(util.path);
+    setIntegration(integration);
+    setDesktopFilePath(util.desktopFilePath);
+    setExecutable(util.executable);
+
+    // Keep unsaved edits of the updater settings
+    if (m_updateDirty)
+        return installedChanged;
+
+    setUpdateType(util.updateType);
+    setUpdateUrl(util.updateUrl);
+    setUpdateDownloadField(util.updateDownloadField);
+    setUpdateDownloadPattern(util.updateDownloadPattern);
+    setUpdateDateField(util.updateDateField);
+    setUpdateVersionField(util.updateVersionField);
+    setUpdateVersionPattern(util.updateVersionPattern);
+    setUpdateCurrentDate(util.updateCurrentDate);
+    setUpdateCurrentVersion(util.updateCurrentVersion);
+
+    bool filtersChanged = m_updateFilters.count() != util.updateFilters.count();
+    for (int i = 0; !filtersChanged && i < m_updateFilters.count(); i++) {
+        filtersChanged = m_updateFilters[i]->field() != util.updateFilters[i].field
+                         || m_updateFilters[i]->pattern() != util.updateFilters[i].pattern;
     }
 
-    metadata->setUpdateDirty(false);
+    if (filtersChanged) {
+        qDeleteAll(m_updateFilters);
+        m_updateFilters.clear();
+        for (const auto& filter : util.updateFilters) {
+            addUpdateFilter(UpdaterFilterModel::createFromUtil(filter, this));
+        }
+        emit updateFiltersChanged();
+    }
 
-    return metadata;
+    setUpdateDirty(false);
+    return installedChanged;
 }
 
 QString AppImageMetadata::name() const { return m_name; }
@@ -305,17 +336,21 @@ QString AppImageMetadata::updateCurrentDate() const { return m_updateCurrentDate
 void AppImageMetadata::setUpdateCurrentDate(const QString& value) {
     if (m_updateCurrentDate != value) {
         m_updateCurrentDate = value;
+        m_updateCurrentDateTime = StringUtil::parseDateTime(value);
         emit updateCurrentDateChanged();
     }
 }
+const QDateTime& AppImageMetadata::updateCurrentDateTime() const { return m_updateCurrentDateTime; }
 
 QString AppImageMetadata::updateCurrentVersion() const { return m_updateCurrentVersion; }
 void AppImageMetadata::setUpdateCurrentVersion(const QString& value) {
     if (m_updateCurrentVersion != value) {
         m_updateCurrentVersion = value;
+        m_updateCurrentVersionKey = VersionKey(value);
         emit updateCurrentVersionChanged();
     }
 }
+const VersionKey& AppImageMetadata::updateCurrentVersionKey() const { return m_updateCurrentVersionKey; }
 
 AppImageMetadata::UpdateProgressState AppImageMetadata::updateProgressState() const { return m_updateProgressState; }
 void AppImageMetadata::setUpdateProgressState(AppImageMetadata::UpdateProgressState value)
@@ -361,6 +396,19 @@ void AppImageMetadata::onUpdateFilterPropertiesChanged()
     setUpdateDirty(true);
 }
 
+void AppImageMetadata::resetUpdateState()
+{
+    if (!m_updaterReleases.isEmpty())
+        clearUpdaterReleases();
+
+    // An update that is still running reports its own progress
+    if (m_updateProgressState == Success || m_updateProgressState == Failed) {
+        setUpdateProgressState(NotStarted);
+        setUpdateBytesReceived(-1);
+        setUpdateBytesTotal(-1);
+    }
+}
+
 void AppImageMetadata::appendUpdateFilter(QQmlListProperty<UpdaterFilterModel>* list, UpdaterFilterModel* filter) {
     AppImageMetadata* metadata = static_cast<AppImageMetadata*>(list->object);
     if (!metadata || !filter) return;
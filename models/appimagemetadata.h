@@ -46,6 +46,7 @@ public:
     explicit AppImageMetadata(QObject* parent = nullptr);
 
     static AppImageMetadata* createFromUtil(const AppImageUtilMetadata& util, QObject* parent = nullptr);
+    bool updateFromUtil(const AppImageUtilMetadata& util);
 
     enum IntegrationType {
         None,
@@ -138,9 +139,11 @@ public:
 
     QString updateCurrentVersion() const;
     void setUpdateCurrentVersion(const QString& value);
+    const VersionKey& updateCurrentVersionKey() const;
 
     QString updateCurrentDate() const;
     void setUpdateCurrentDate(const QString& value);
+    const QDateTime& updateCurrentDateTime() const;
 
     UpdateProgressState updateProgressState() const;
     void setUpdateProgressState(UpdateProgressState value);
@@ -204,13 +207,16 @@ private:
     bool m_updateDirty = false;
     QList<UpdaterReleaseModel*> m_updaterReleases;
     QString m_updateCurrentVersion;
+    VersionKey m_updateCurrentVersionKey;
     QString m_updateCurrentDate;
+    QDateTime m_updateCurrentDateTime;
     UpdateProgressState m_updateProgressState = NotStarted;
     qint64 m_updateBytesReceived = -1;
     qint64 m_updateBytesTotal = -1;
 
     void onUpdateFilterChanged();
     void onUpdateFilterPropertiesChanged();
+    void resetUpdateState();
 
     static void appendUpdateFilter(QQmlListProperty<UpdaterFilterModel>* list, UpdaterFilterModel* filter);
     static qsizetype updateFiltersCount(QQmlListProperty<UpdaterFilterModel>* list);
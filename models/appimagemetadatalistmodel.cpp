@@ -10,6 +10,11 @@ const QList<AppImageMetadata*>& AppImageMetadataListModel::items() const
     return m_items;
 }
 
+AppImageMetadata* AppImageMetadataListModel::itemByPath(const QString& path) const
+{
+    return m_itemsByPath.value(path);
+}
+
 bool AppImageMetadataListModel::hasAnyNewRelease() const
 {
     for (const auto& item : m_items) {
@@ -81,6 +86,7 @@ void AppImageMetadataListModel::addMetadata(AppImageMetadata* metadata)
 {
     beginInsertRows(QModelIndex(), m_items.count(), m_items.count());
     m_items.append(metadata);
+    m_itemsByPath.insert(metadata->path(), metadata);
     endInsertRows();
 
     connect(metadata, &AppImageMetadata::hasNewReleaseChanged, this, [this]() {
@@ -91,11 +97,105 @@ void AppImageMetadataListModel::addMetadata(AppImageMetadata* metadata)
     emit hasAnyNewReleaseChanged();
 }
 
+AppImageMetadata* AppImageMetadataListModel::upsertMetadata(const AppImageUtilMetadata& util)
+{
+    AppImageMetadata* metadata = m_itemsByPath.value(util.path);
+    if (!metadata) {
+        metadata = AppImageMetadata::createFromUtil(util, this);
+        insertSorted(metadata);
+        emit countChanged();
+        emit hasAnyNewReleaseChanged();
+        return metadata;
+    }
+
+    // Reuse the existing item so its delegate survives, and only report the roles that changed
+    int row = m_items.indexOf(metadata);
+    const QList<QVariant> before = roleValues(row);
+    const bool installedChanged = metadata->updateFromUtil(util);
+    const QList<QVariant> after = roleValues(row);
+
+    QList<int> roles;
+    for (int i = 0; i < before.count(); i++) {
+        if (before[i] != after[i])
+            roles.append(NameRole + i);
+    }
+
+    // The releases and update progress were reset for the new version
+    if (installedChanged) {
+        if (!roles.contains(HasNewReleaseRole))
+            roles.append(HasNewReleaseRole);
+        roles << UpdaterReleasesRole << UpdateProgressStateRole << UpdateBytesReceivedRole << UpdateBytesTotalRole;
+    }
+
+    if (!roles.isEmpty()) {
+        QModelIndex idx = index(row);
+        emit dataChanged(idx, idx, roles);
+
+        if (roles.contains(NameRole) || roles.contains(HasNewReleaseRole))
+            moveToSortedRow(row);
+    }
+
+    return metadata;
+}
+
+bool AppImageMetadataListModel::removeMetadata(const QString& path)
+{
+    AppImageMetadata* metadata = m_itemsByPath.value(path);
+    if (!metadata)
+        return false;
+
+    int row = m_items.indexOf(metadata);
+    beginRemoveRows(QModelIndex(), row, row);
+    m_items.removeAt(row);
+    m_itemsByPath.remove(path);
+    endRemoveRows();
+    metadata->deleteLater();
+
+    emit countChanged();
+    emit hasAnyNewReleaseChanged();
+    return true;
+}
+
+QStringList AppImageMetadataListModel::retainPaths(const QSet<QString>& paths)
+{
+    QStringList removed;
+
+    // Walk backwards so contiguous runs are removed with a single signal
+    int row = m_items.count() - 1;
+    while (row >= 0) {
+        if (paths.contains(m_items[row]->path())) {
+            row--;
+            continue;
+        }
+
+        int last = row;
+        while (row >= 0 && !paths.contains(m_items[row]->path()))
+            row--;
+
+        beginRemoveRows(QModelIndex(), row + 1, last);
+        for (int i = last; i > row; i--) {
+            AppImageMetadata* metadata = m_items.takeAt(i);
+            m_itemsByPath.remove(metadata->path());
+            removed.append(metadata->path());
+            metadata->deleteLater();
+        }
+        endRemoveRows();
+    }
+
+    if (!removed.isEmpty()) {
+        emit countChanged();
+        emit hasAnyNewReleaseChanged();
+    }
+
+    return removed;
+}
+
 void AppImageMetadataListModel::clear()
 {
     beginResetModel();
     qDeleteAll(m_items);
     m_items.clear();
+    m_itemsByPath.clear();
     endResetModel();
     emit countChanged();
     emit hasAnyNewReleaseChanged();
@@ -128,16 +228,68 @@ void AppImageMetadataListModel::updateAllItems() {
 
 void AppImageMetadataListModel::sort()
 {
-    beginResetModel();
+    // Move rows into place one by one instead of resetting, so delegates and
+    // scroll position survive; the list is nearly sorted in practice
+    QList<AppImageMetadata*> sorted = m_items;
+    std::stable_sort(sorted.begin(), sorted.end(), lessThan);
 
-    std::sort(m_items.begin(), m_items.end(),
-              [](AppImageMetadata* a, AppImageMetadata* b) {
+    for (int target = 0; target < sorted.count(); target++) {
+        if (m_items[target] == sorted[target])
+            continue;
 
-                  if (a->hasNewRelease() != b->hasNewRelease())
-                      return a->hasNewRelease() > b->hasNewRelease();
+        int row = m_items.indexOf(sorted[target], target + 1);
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), target);
+        m_items.move(row, target);
+        endMoveRows();
+    }
+}
 
-                  return QString::localeAwareCompare(a->name(), b->name()) < 0;
-              });
+bool AppImageMetadataListModel::lessThan(AppImageMetadata* a, AppImageMetadata* b)
+{
+    if (a->hasNewRelease() != b->hasNewRelease())
+        return a->hasNewRelease() > b->hasNewRelease();
 
-    endResetModel();
+    return QString::localeAwareCompare(a->name(), b->name()) < 0;
+}
+
+void AppImageMetadataListModel::insertSorted(AppImageMetadata* metadata)
+{
+    auto it = std::upper_bound(m_items.begin(), m_items.end(), metadata, lessThan);
+    int row = static_cast<int>(it - m_items.begin());
+
+    beginInsertRows(QModelIndex(), row, row);
+    m_items.insert(row, metadata);
+    m_itemsByPath.insert(metadata->path(), metadata);
+    endInsertRows();
+
+    connect(metadata, &AppImageMetadata::hasNewReleaseChanged, this, [this]() {
+        emit hasAnyNewReleaseChanged();
+    });
+}
+
+void AppImageMetadataListModel::moveToSortedRow(int row)
+{
+    AppImageMetadata* metadata = m_items[row];
+    m_items.removeAt(row);
+    auto it = std::upper_bound(m_items.begin(), m_items.end(), metadata, lessThan);
+    int target = static_cast<int>(it - m_items.begin());
+    m_items.insert(row, metadata);
+
+    if (target == row)
+        return;
+
+    // beginMoveRows takes the destination before the move is applied
+    beginMoveRows(QModelIndex(), row, row, QModelIndex(), target > row ? target + 1 : target);
+    m_items.move(row, target);
+    endMoveRows();
+}
+
+QList<QVariant> AppImageMetadataListModel::roleValues(int row) const
+{
+    // Every role up to the updater releases, the rest only change on a version change
+    QList<QVariant> values;
+    QModelIndex idx = index(row);
+    for (int role = NameRole; role < UpdaterReleasesRole; role++)
+        values.append(data(idx, role));
+    return values;
 }
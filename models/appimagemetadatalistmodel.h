@@ -4,6 +4,8 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QHash>
+#include <QSet>
 #include "appimagemetadata.h"
 
 class AppImageMetadataListModel : public QAbstractListModel
@@ -34,6 +36,7 @@ public:
     explicit AppImageMetadataListModel(QObject* parent = nullptr);
 
     const QList<AppImageMetadata*>& items() const;
+    AppImageMetadata* itemByPath(const QString& path) const;
     bool hasAnyNewRelease() const;
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -44,10 +47,19 @@ public:
     void updateItem(AppImageMetadata* item);
     void updateAllItems();
     Q_INVOKABLE void addMetadata(AppImageMetadata* metadata);
+    AppImageMetadata* upsertMetadata(const AppImageUtilMetadata& util);
+    bool removeMetadata(const QString& path);
+    QStringList retainPaths(const QSet<QString>& paths);
     Q_INVOKABLE void sort();
 
 private:
     QList<AppImageMetadata*> m_items;
+    QHash<QString, AppImageMetadata*> m_itemsByPath;
+
+    static bool lessThan(AppImageMetadata* a, AppImageMetadata* b);
+    void insertSorted(AppImageMetadata* metadata);
+    void moveToSortedRow(int row);
+    QList<QVariant> roleValues(int row) const;
 
 signals:
     void countChanged();
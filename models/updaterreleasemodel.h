@@ -1,6 +1,10 @@
 #ifndef UPDATERRELEASEMODEL_H
 #define UPDATERRELEASEMODEL_H
 
+#include "utils/stringutil.h"
+#include "utils/versionutil.h"
+
+#include <QDateTime>
 #include <QObject>
 
 class UpdaterReleaseModel : public QObject
@@ -19,10 +23,14 @@ public:
     void setDate(const QString& value) {
         if (m_date != value) {
             m_date = value;
+            m_dateTime = StringUtil::parseDateTime(value);
             emit dateChanged();
         }
     }
 
+    // Parsed once when the date is set
+    const QDateTime& dateTime() const { return m_dateTime; }
+
     QString download() const { return m_download; }
     void setDownload(const QString& value) {
         if (m_download != value) {
@@ -35,10 +43,14 @@ public:
     void setVersion(const QString& value) {
         if (m_version != value) {
             m_version = value;
+            m_versionKey = VersionKey(value);
             emit versionChanged();
         }
     }
 
+    // Parsed once when the version is set
+    const VersionKey& versionKey() const { return m_versionKey; }
+
     bool isNew() const { return m_isNew; }
     void setIsNew(bool value) {
         if (m_isNew != value) {
@@ -64,8 +76,10 @@ signals:
 
 private:
     QString m_date = QString();
+    QDateTime m_dateTime;
     QString m_download = QString();
     QString m_version = QString();
+    VersionKey m_versionKey;
     bool m_isNew = false;
     bool m_isSelected = false;
 };
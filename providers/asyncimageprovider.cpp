@@ -0,0 +1,126 @@
+#include "asyncimageprovider.h"
+#include "memoryimageprovider.h"
+#include "utils/thumbnailcacheutil.h"
+
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QThread>
+
+// ----------------- Public -----------------
+
+AsyncImageResponse::AsyncImageResponse(const QString &id, const QString &iconPath, const QSize &requestedSize, QThreadPool *pool)
+    : m_id(id), m_iconPath(iconPath), m_requestedSize(requestedSize), m_pool(pool)
+{
+    // Owned by the engine, which deletes it after finished
+    setAutoDelete(false);
+}
+
+QQuickTextureFactory *AsyncImageResponse::textureFactory() const
+{
+    return QQuickTextureFactory::textureFactoryForImage(m_image);
+}
+
+void AsyncImageResponse::cancel()
+{
+    m_canceled = true;
+
+    // Not started yet, ie its delegate scrolled off-screen while queued
+    if (m_pool->tryTake(this))
+        finish();
+}
+
+void AsyncImageResponse::run()
+{
+    if (!m_canceled) {
+        auto* memory = MemoryImageProvider::instance();
+        m_image = memory->requestImage(m_id, nullptr, m_requestedSize);
+
+        if (m_image.isNull() && !m_canceled) {
+            QImage image = ThumbnailCacheUtil::load(m_iconPath);
+            if (!image.isNull()) {
+                memory->setImage(m_id, image);
+                m_image = memory->requestImage(m_id, nullptr, m_requestedSize);
+            }
+        }
+    }
+
+    finish();
+}
+
+AsyncImageProvider* AsyncImageProvider::instance() {
+    static AsyncImageProvider* singleton = new AsyncImageProvider();
+    return singleton;
+}
+
+const QString AsyncImageProvider::providerName = "asyncimage";
+const QString AsyncImageProvider::revisionQuery = "?v=";
+
+QQuickImageResponse *AsyncImageProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    // Drop the revision getUrl appended
+    const qsizetype query = id.lastIndexOf(revisionQuery);
+    const QString sourceId = query >= 0 ? id.left(query) : id;
+
+    QString iconPath;
+    {
+        QMutexLocker locker(&m_mutex);
+        iconPath = m_sources.value(sourceId).iconPath;
+    }
+
+    auto* response = new AsyncImageResponse(sourceId, iconPath, requestedSize, &m_pool);
+    m_pool.start(response);
+    return response;
+}
+
+void AsyncImageProvider::setImageSource(const QString &id, const QString &iconPath)
+{
+    const QDateTime modified = QFileInfo(iconPath).lastModified();
+    {
+        QMutexLocker locker(&m_mutex);
+        Source& source = m_sources[id];
+        if (source.revision > 0 && source.iconPath == iconPath && source.modified == modified)
+            return;
+
+        source.iconPath = iconPath;
+        source.modified = modified;
+        // Unique across ids, so an id that is removed and added again gets a new url
+        source.revision = ++m_revision;
+    }
+
+    MemoryImageProvider::instance()->removeImage(id);
+}
+
+QString AsyncImageProvider::getUrl(const QString &id) {
+    int revision = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        revision = m_sources.value(id).revision;
+    }
+
+    return QString("image://%1/%2%3%4").arg(providerName, id, revisionQuery, QString::number(revision));
+}
+
+void AsyncImageProvider::removeImage(const QString &id)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_sources.remove(id);
+    }
+
+    MemoryImageProvider::instance()->removeImage(id);
+}
+
+// ----------------- Private -----------------
+
+void AsyncImageResponse::finish()
+{
+    // cancel() and run() may race to finish a response that was taken as it started
+    if (!m_finished.exchange(true))
+        emit finished();
+}
+
+AsyncImageProvider::AsyncImageProvider()
+{
+    // Leave a core for the gui and render threads
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
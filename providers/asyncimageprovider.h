@@ -0,0 +1,76 @@
+#ifndef ASYNCIMAGEPROVIDER_H
+#define ASYNCIMAGEPROVIDER_H
+
+#pragma once
+
+#include <QQuickAsyncImageProvider>
+#include <QQuickImageResponse>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QSize>
+
+#include <atomic>
+
+class AsyncImageResponse : public QQuickImageResponse, public QRunnable
+{
+public:
+    AsyncImageResponse(const QString &id, const QString &iconPath, const QSize &requestedSize, QThreadPool *pool);
+
+    QQuickTextureFactory *textureFactory() const override;
+    void cancel() override;
+    void run() override;
+
+private:
+    const QString m_id;
+    const QString m_iconPath;
+    const QSize m_requestedSize;
+    QThreadPool *m_pool;
+    QImage m_image;
+    std::atomic_bool m_canceled = false;
+    std::atomic_bool m_finished = false;
+
+    void finish();
+};
+
+class AsyncImageProvider : public QQuickAsyncImageProvider
+{
+public:
+    static AsyncImageProvider* instance();
+    static const QString providerName;
+
+    // Decodes and scales on the provider's own pool, so neither the gui nor the render thread waits
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
+
+    // Sets the icon file decoded on demand for a given id, the cached image is dropped if the file or its mtime changed
+    void setImageSource(const QString &id, const QString &iconPath);
+
+    // The url carries a revision that changes with the icon, so QML does not keep showing its cached pixmap
+    QString getUrl(const QString &id);
+
+    // Forgets the icon file and drops the cached image
+    void removeImage(const QString &id);
+
+private:
+    AsyncImageProvider();
+
+    struct Source {
+        QString iconPath;
+        QDateTime modified;
+        int revision = 0;
+    };
+
+    static const QString revisionQuery;
+
+    QThreadPool m_pool;
+    QHash<QString, Source> m_sources;
+    int m_revision = 0;
+    mutable QMutex m_mutex;
+
+    Q_DISABLE_COPY(AsyncImageProvider);
+};
+
+#endif // ASYNCIMAGEPROVIDER_H
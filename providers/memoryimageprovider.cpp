@@ -1,5 +1,7 @@
 #include "memoryimageprovider.h"
 
+#include <QMutexLocker>
+
 // ----------------- Public -----------------
 
 const QString MemoryImageProvider::providerName = "memoryimage";
@@ -10,36 +12,113 @@ MemoryImageProvider* MemoryImageProvider::instance() {
 }
 
 QImage MemoryImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize) {
-    QImage img = m_images.value(id);
+    const bool wantsScaled = requestedSize.width() > 0 && requestedSize.height() > 0;
+    QImage source;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (wantsScaled) {
+            if (!m_requestedSizes.contains(requestedSize))
+                m_requestedSizes.append(requestedSize);
 
-    if (img.isNull())
+            if (QImage* variant = m_images.object(variantKey(id, requestedSize))) {
+                if (size)
+                    *size = variant->size();
+                return *variant;
+            }
+        }
+
+        source = m_sources.value(id);
+    }
+
+    if (source.isNull())
         return QImage();
 
     if (size)
-        *size = img.size();
+        *size = source.size();
+
+    if (!wantsScaled)
+        return source;
 
-    if (requestedSize.width() > 0 && requestedSize.height() > 0)
-        img = img.scaled(requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    // Scale outside the lock, then keep the variant for the next delegate
+    QImage img = scaled(source, requestedSize);
+
+    QMutexLocker locker(&m_mutex);
+    const QString key = variantKey(id, requestedSize);
+    insert(key, img);
+    m_variants[id].insert(key);
 
     return img;
 }
 
 void MemoryImageProvider::setImage(const QString &id, const QImage &img) {
-    m_images[id] = img;
+    QImage source = img;
+    if (source.width() > maxSourceSize || source.height() > maxSourceSize)
+        source = scaled(source, QSize(maxSourceSize, maxSourceSize));
+
+    QList<QSize> sizes;
+    {
+        QMutexLocker locker(&m_mutex);
+        sizes = m_requestedSizes;
+    }
+
+    QHash<QString, QImage> variants;
+    if (!source.isNull()) {
+        for (const QSize &size : sizes)
+            variants.insert(variantKey(id, size), scaled(source, size));
+    }
+
+    QMutexLocker locker(&m_mutex);
+    for (const QString &key : m_variants.take(id))
+        m_images.remove(key);
+
+    if (source.isNull()) {
+        m_sources.remove(id);
+        return;
+    }
+
+    m_sources.insert(id, source);
+    for (auto it = variants.cbegin(); it != variants.cend(); ++it) {
+        insert(it.key(), it.value());
+        m_variants[id].insert(it.key());
+    }
 }
 
 QString MemoryImageProvider::getUrl(const QString &id) {
     return QString("image://%1/%2").arg(providerName, id);
 }
 
-void MemoryImageProvider::clearImages() {
-    m_images.clear();
+void MemoryImageProvider::removeImage(const QString &id) {
+    QMutexLocker locker(&m_mutex);
+    m_sources.remove(id);
+    for (const QString &key : m_variants.take(id))
+        m_images.remove(key);
 }
 
-void MemoryImageProvider::removeImage(const QString &id) {
-    m_images.remove(id);
+void MemoryImageProvider::setMaxBytes(qint64 bytes) {
+    QMutexLocker locker(&m_mutex);
+    m_images.setMaxCost(bytes);
 }
 
 // ----------------- Private -----------------
 
-MemoryImageProvider::MemoryImageProvider() : QQuickImageProvider(QQuickImageProvider::Image) {}
+const qint64 MemoryImageProvider::defaultMaxBytes = 64 * 1024 * 1024;
+const int MemoryImageProvider::maxSourceSize = 256;
+
+MemoryImageProvider::MemoryImageProvider() : QQuickImageProvider(QQuickImageProvider::Image) {
+    m_images.setMaxCost(defaultMaxBytes);
+}
+
+void MemoryImageProvider::insert(const QString &key, const QImage &image) {
+    // Cost is the decoded size, so the budget bounds the memory the variants use
+    m_images.insert(key, new QImage(image), qMax<qsizetype>(1, image.sizeInBytes()));
+}
+
+const QString MemoryImageProvider::variantKey(const QString &id, const QSize &size) {
+    return QString("%1@%2x%3").arg(id).arg(size.width()).arg(size.height());
+}
+
+QImage MemoryImageProvider::scaled(const QImage &image, const QSize &size) {
+    return image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+}
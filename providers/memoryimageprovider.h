@@ -4,8 +4,13 @@
 #pragma once
 
 #include <QQuickImageProvider>
+#include <QCache>
 #include <QImage>
 #include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QSize>
 #include <QString>
 
 class MemoryImageProvider : public QQuickImageProvider
@@ -17,19 +22,35 @@ public:
     // Override requestImage to provide images by id
     QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
 
-    // Method to set or update an image for a given id
+    // Method to set or update an image for a given id, also rebuilds the scaled variants
+    // for every size requested so far. Safe to call from any thread.
     void setImage(const QString &id, const QImage &image);
 
     QString getUrl(const QString &id);
 
-    void clearImages();
-
+    // Invalidates the image and every scaled variant of it
     void removeImage(const QString &id);
 
+    // Sets the budget of the scaled variants in bytes, least recently used ones are evicted first.
+    // Sources are kept until removed, nothing could decode them again.
+    void setMaxBytes(qint64 bytes);
+
 private:
     MemoryImageProvider();
 
-    QHash<QString, QImage> m_images;
+    static const qint64 defaultMaxBytes;
+    static const int maxSourceSize;
+
+    QHash<QString, QImage> m_sources;
+    QCache<QString, QImage> m_images;
+    QHash<QString, QSet<QString>> m_variants;
+    QList<QSize> m_requestedSizes;
+    // Images are set from worker threads and requested from the scene graph
+    mutable QMutex m_mutex;
+
+    void insert(const QString &key, const QImage &image);
+    static const QString variantKey(const QString &id, const QSize &size);
+    static QImage scaled(const QImage &image, const QSize &size);
 
     Q_DISABLE_COPY(MemoryImageProvider);
 };
@@ -614,6 +614,10 @@ Item {
                                     text: "Json"
                                     value: "json"
                                 }
+                                ListElement {
+                                    text: "Zsync"
+                                    value: "zsync"
+                                }
                             }
                             textRole: "text"
                             valueRole: "value"
@@ -729,7 +733,7 @@ Item {
                     Label {
                         text: qsTr("Url")
                         font.bold: true
-                        visible: utils.isType("static", "json")
+                        visible: utils.isType("static", "json", "zsync")
                     }
 
                     RoundedTextArea {
@@ -740,15 +744,17 @@ Item {
                             if (AppImageManager.appImageMetadata)
                                 AppImageManager.appImageMetadata.updateUrl = text
                         }
-                        placeholderText: "ex: https://api.github.com/repos/dev/proj/releases/latest"
+                        placeholderText: utils.isType("zsync")
+                                         ? qsTr("Empty to use the update information embedded in the AppImage")
+                                         : "ex: https://api.github.com/repos/dev/proj/releases/latest"
                         wrapMode: TextEdit.Wrap
                         Layout.fillWidth: true
-                        visible: utils.isType("static", "json")
+                        visible: utils.isType("static", "json", "zsync")
                     }
 
                     Item {
                         Layout.preferredHeight: 5
-                        visible: utils.isType("static", "json")
+                        visible: utils.isType("static", "json", "zsync")
                     }
 
                     Label {
@@ -806,7 +812,7 @@ Item {
                     Label {
                         text: getText()
                         font.bold: true
-                        visible: utils.isType("static", "json")
+                        visible: utils.isType("static", "json", "zsync")
 
                         function getText() {
                             if (utils.isType("static"))
@@ -828,11 +834,13 @@ Item {
                         placeholderText: getPlaceholderText()
                         wrapMode: TextEdit.Wrap
                         Layout.fillWidth: true
-                        visible: utils.isType("static", "json")
+                        visible: utils.isType("static", "json", "zsync")
 
                         function getPlaceholderText() {
                             if (utils.isType("static"))
                                 return qsTr("ex: url")
+                            else if (utils.isType("zsync"))
+                                return qsTr("ex: Filename")
                             else
                                 return qsTr("ex: tag_name")
                         }
@@ -840,13 +848,13 @@ Item {
 
                     Item {
                         Layout.preferredHeight: 5
-                        visible: utils.isType("static", "json")
+                        visible: utils.isType("static", "json", "zsync")
                     }
 
                     Label {
                         text: qsTr("Version Pattern")
                         font.bold: true
-                        visible: utils.isType("static", "json")
+                        visible: utils.isType("static", "json", "zsync")
                     }
 
                     RoundedTextArea {
@@ -858,23 +866,23 @@ Item {
                             if (AppImageManager.appImageMetadata)
                                 AppImageManager.appImageMetadata.updateVersionPattern = text
                         }
-                        placeholderText: utils.isType("static")
+                        placeholderText: utils.isType("static", "zsync")
                                          ? "ex: appName-(.*)-x86_64\\.AppImage"
                                          : "ex: appName-(.*)"
                         wrapMode: TextEdit.Wrap
                         Layout.fillWidth: true
-                        visible: utils.isType("static", "json")
+                        visible: utils.isType("static", "json", "zsync")
                     }
 
                     Item {
                         Layout.preferredHeight: 5
-                        visible: utils.isType("static", "json")
+                        visible: utils.isType("static", "json", "zsync")
                     }
 
                     Label {
                         text: getText()
                         font.bold: true
-                        visible: utils.isType("static", "json")
+                        visible: utils.isType("static", "json", "zsync")
 
                         function getText() {
                             if (utils.isType("static"))
@@ -896,11 +904,13 @@ Item {
                         placeholderText: getPlaceholderText()
                         wrapMode: TextEdit.Wrap
                         Layout.fillWidth: true
-                        visible: utils.isType("static", "json")
+                        visible: utils.isType("static", "json", "zsync")
 
                         function getPlaceholderText() {
                             if (utils.isType("static"))
                                 return qsTr("ex: last-modified")
+                            else if (utils.isType("zsync"))
+                                return qsTr("ex: MTime")
                             else
                                 return qsTr("ex: published_at")
                         }
@@ -908,7 +918,7 @@ Item {
 
                     Item {
                         Layout.preferredHeight: 5
-                        visible: utils.isType("static", "json")
+                        visible: utils.isType("static", "json", "zsync")
                     }
 
                     Label {
@@ -2,13 +2,19 @@
 #include "managers/errormanager.h"
 #include "managers/settingsmanager.h"
 #include "utils/archiveutil.h"
-#include "utils/networkutil.h"
+#include "utils/desktopindexutil.h"
+#include "utils/downloadutil.h"
+#include "utils/metadatacacheutil.h"
+#include "utils/regexutil.h"
+#include "utils/squashfsutil.h"
+#include "utils/zsyncutil.h"
 
 #include <QCoreApplication>
 #include <QCryptographicHash>
 #include <QDir>
 #include <QDirIterator>
 #include <QFile>
+#include <QFileSystemWatcher>
 #include <QImage>
 #include <QProcess>
 #include <QSettings>
@@ -21,8 +27,93 @@
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QJsonParseError>
+#include <QMutex>
+#include <QPromise>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QtConcurrent/QtConcurrentMap>
 #include <QtConcurrent/QtConcurrentRun>
 
+#include <cstring>
+
+namespace {
+
+// Shared between the download callbacks on the UI thread and the streaming extraction
+struct DownloadStream {
+    QMutex mutex;
+    QWaitCondition changed;
+    qint64 received = 0;
+    bool finished = false;
+    bool downloaded = false;
+    bool restarted = false;
+};
+
+// Extracts a zipped appimage from partPath while it is still being downloaded.
+// Returns false if the payload is not a zip or the stream could not be followed,
+// the completed file is then handled as usual.
+bool extractZipFromDownload(const QString& partPath, const QString& newPath, QSharedPointer<DownloadStream> stream)
+{
+    QFile file(partPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+        return false;
+
+    // Read what is on disk, waiting at the end of the file for the download to write more
+    auto tailRead = [&file, stream](char* data, qint64 maxSize) -> qint64 {
+        forever {
+            const qint64 size = file.read(data, maxSize);
+            if (size != 0)
+                return size;
+
+            QMutexLocker locker(&stream->mutex);
+            if (stream->restarted || (stream->finished && !stream->downloaded))
+                return -1;
+            if (stream->finished)
+                return file.read(data, maxSize);
+
+            stream->changed.wait(&stream->mutex, 250);
+        }
+    };
+
+    QByteArray header(4, Qt::Uninitialized);
+    qint64 headerSize = 0;
+    while (headerSize < header.size()) {
+        const qint64 size = tailRead(header.data() + headerSize, header.size() - headerSize);
+        if (size <= 0)
+            return false;
+        headerSize += size;
+    }
+
+    if (!ArchiveUtil::isZip(header))
+        return false;
+
+    // Hand the sniffed bytes back to libarchive before following the file
+    qint64 headerPos = 0;
+    const bool extracted = ArchiveUtil::extractAppImageFromZipStream([&](char* data, qint64 maxSize) -> qint64 {
+        if (headerPos < header.size()) {
+            const qint64 size = qMin(maxSize, header.size() - headerPos);
+            std::memcpy(data, header.constData() + headerPos, size);
+            headerPos += size;
+            return size;
+        }
+        return tailRead(data, maxSize);
+    }, newPath);
+
+    QMutexLocker locker(&stream->mutex);
+    return extracted && !stream->restarted;
+}
+
+// The tail reader waits on the download for its whole duration, so it gets its own
+// threads instead of holding global pool ones the list loading needs. Never deleted,
+// a reader still waiting at exit must not block shutdown.
+QThreadPool* streamPool()
+{
+    static QThreadPool* pool = new QThreadPool();
+    return pool;
+}
+
+}
+
 // ----------------- Public -----------------
 
 AppImageUtil::AppImageUtil(const QString& path)
@@ -63,6 +154,45 @@ const QString AppImageUtil::getChecksum(const QString& path, const QCryptographi
     return hash.result().toHex();
 }
 
+const QString AppImageUtil::getFingerprint(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        ErrorManager::instance()->reportError("Failed to open file:" + path);
+        return QString();
+    }
+
+    constexpr qint64 elfHeaderSize = 64;
+    constexpr qint64 superblockSize = 96;
+    constexpr qint64 sampleSize = 4096;
+    constexpr int sampleCount = 8;
+
+    const qint64 size = file.size();
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(QByteArrayView(reinterpret_cast<const char*>(&size), sizeof(size)));
+
+    auto addRange = [&](qint64 offset, qint64 length) {
+        if (offset < 0 || offset >= size || !file.seek(offset))
+            return;
+        hash.addData(file.read(qMin(length, size - offset)));
+    };
+
+    // ELF header
+    addRange(0, elfHeaderSize);
+
+    // Squashfs superblock, holds the image size, inode count and mod time
+    const qint64 payloadOffset = qMax<qint64>(0, getPayloadOffset(file));
+    addRange(payloadOffset, superblockSize);
+
+    // Evenly spaced samples across the payload, the last one ends at EOF
+    const qint64 payloadSize = size - payloadOffset;
+    for (int i = 0; i < sampleCount; ++i) {
+        qint64 offset = payloadOffset + (payloadSize - sampleSize) * i / (sampleCount - 1);
+        addRange(qMax(payloadOffset, offset), sampleSize);
+    }
+
+    return hash.result().toHex();
+}
+
 const bool AppImageUtil::isExecutable(const QString& path) {
     QFileInfo fileInfo(path);
     return fileInfo.isExecutable();
@@ -91,6 +221,12 @@ void AppImageUtil::mountAppImageAsync()
 {
     unmountAppImage();
 
+    // Read the few files we need straight from the squashfs image, without running the appimage
+    if (extractFromSquashfs()) {
+        emit mountFinished(true);
+        return;
+    }
+
     if (!isExecutable(m_path)) {
         ErrorManager::instance()->reportError("File is not executable: " + m_path);
         emit mountFinished(false);
@@ -113,40 +249,6 @@ void AppImageUtil::mountAppImageAsync()
     m_process->start();
 }
 
-bool AppImageUtil::mountAppImage(int mountTimeoutMs)
-{
-    QEventLoop loop;
-    bool result = false;
-
-    QMetaObject::Connection conn = connect(this, &AppImageUtil::mountFinished, [&](bool success) {
-        result = success;
-        loop.quit();
-    });
-
-    mountAppImageAsync();
-
-    QTimer mountTimer;
-    mountTimer.setSingleShot(true);
-    QObject::connect(&mountTimer, &QTimer::timeout, [&]() {
-        // Only apply timeout if we are still mounting
-        if (m_process && !m_tempExtractDir.isEmpty()) {
-            return;
-        }
-
-        if (m_process) {
-            ErrorManager::instance()->reportError("AppImage mount timed out.");
-            unmountAppImage();
-        }
-        loop.quit();
-    });
-    mountTimer.start(mountTimeoutMs);
-
-    loop.exec();
-    disconnect(conn);
-
-    return result;
-}
-
 void AppImageUtil::onMountStdoutReady()
 {
     if (!m_process)
@@ -159,34 +261,42 @@ void AppImageUtil::onMountStdoutReady()
     if (possiblePath.isEmpty())
         return;
 
-    auto checkMount = new QTimer(this);
-    checkMount->setInterval(50);
-    checkMount->setSingleShot(false);
-
-    connect(checkMount, &QTimer::timeout, this, [this, possiblePath, checkMount]() {
-        if (!m_process || m_process->state() != QProcess::Running) {
-            checkMount->stop();
-            checkMount->deleteLater();
-            emit mountFinished(false);
-            return;
-        }
+    disconnect(m_process, &QProcess::readyReadStandardOutput,
+               this, &AppImageUtil::onMountStdoutReady);
 
-        if (QDir(possiblePath).exists()) {
-            m_mountPath = possiblePath;
-            emit mountFinished(true);
-            checkMount->stop();
-            checkMount->deleteLater();
+    if (isMountReady(possiblePath)) {
+        onMountReady(possiblePath);
+        return;
+    }
 
-            if (m_process) {
-                disconnect(m_process, &QProcess::readyReadStandardOutput,
-                           this, &AppImageUtil::onMountStdoutReady);
-            }
-        }
+    // Wait for the mount point to show up instead of polling for it,
+    // a failed mount is reported through the process finishing
+    m_mountWatcher = new QFileSystemWatcher({ QFileInfo(possiblePath).absolutePath() }, this);
+    connect(m_mountWatcher, &QFileSystemWatcher::directoryChanged, this, [this, possiblePath]() {
+        if (m_mountWatcher && isMountReady(possiblePath))
+            onMountReady(possiblePath);
     });
+}
+
+bool AppImageUtil::isMountReady(const QString& path) const
+{
+    if (!m_process || m_process->state() != QProcess::Running)
+        return false;
 
-    checkMount->start();
+    // The runtime prints the mount point once it is mounted, it only has to exist
+    return QDir(path).exists();
 }
 
+void AppImageUtil::onMountReady(const QString& path)
+{
+    if (m_mountWatcher) {
+        m_mountWatcher->deleteLater();
+        m_mountWatcher = nullptr;
+    }
+
+    m_mountPath = path;
+    emit mountFinished(true);
+}
 
 void AppImageUtil::onMountFinished(int exitCode, QProcess::ExitStatus status)
 {
@@ -194,8 +304,13 @@ void AppImageUtil::onMountFinished(int exitCode, QProcess::ExitStatus status)
     if (!m_mountPath.isEmpty())
         return;
 
+    if (m_mountWatcher) {
+        m_mountWatcher->deleteLater();
+        m_mountWatcher = nullptr;
+    }
+
     // Fallback to extract
-    delete m_process;
+    m_process->deleteLater();
     m_process = nullptr;
     extractAppImage();
 }
@@ -213,11 +328,24 @@ void AppImageUtil::extractAppImage()
 
     m_tempExtractDir = tempDir;
 
+    // Only pull out what the metadata needs, the icon patterns follow once the desktop file is known
+    m_selectiveExtract = true;
+    m_iconPatternsQueued = false;
+    m_extractPatterns = { "*.desktop", ".DirIcon" };
+    startExtract(m_extractPatterns.takeFirst());
+}
+
+void AppImageUtil::startExtract(const QString& pattern)
+{
+    QStringList arguments = {"--appimage-extract"};
+    if (!pattern.isEmpty())
+        arguments.append(pattern);
+
     m_process = new QProcess(this);
     m_process->setProgram(m_path);
-    m_process->setArguments({"--appimage-extract"});
+    m_process->setArguments(arguments);
     m_process->setProcessChannelMode(QProcess::MergedChannels);
-    m_process->setWorkingDirectory(tempDir);
+    m_process->setWorkingDirectory(m_tempExtractDir);
 
     connect(m_process, &QProcess::finished,
             this, &AppImageUtil::onExtractFinished);
@@ -225,9 +353,83 @@ void AppImageUtil::extractAppImage()
     m_process->start();
 }
 
+const QStringList AppImageUtil::iconExtractPatterns(const QString& rootPath) const
+{
+    QStringList patterns;
+    QDir rootDir(rootPath);
+
+    // .DirIcon is usually a symlink to the real icon
+    QFileInfo dirIcon(rootDir.filePath(".DirIcon"));
+    if (dirIcon.isSymLink()) {
+        const QString target = rootDir.relativeFilePath(dirIcon.symLinkTarget());
+        if (!target.startsWith(".."))
+            patterns.append(target);
+    }
+
+    const QFileInfoList desktopFiles = rootDir.entryInfoList({"*.desktop"}, QDir::Files);
+    if (desktopFiles.isEmpty())
+        return patterns;
+
+    AppImageUtilMetadata metadata;
+    parseDesktopPathForMetadata(desktopFiles.first().absoluteFilePath(), metadata);
+    const QString iconName = QFileInfo(metadata.iconPath).completeBaseName();
+    if (iconName.isEmpty())
+        return patterns;
+
+    // The runtime matches with fnmatch(FNM_PATHNAME), a * never crosses a /. So the size
+    // dir is matched on its own, which covers the app icons of every hicolor dir in
+    // iconSearchDirs, then pixmaps and the icon next to the desktop file
+    patterns.append("usr/share/icons/hicolor/*/apps/" + iconName + ".*");
+    patterns.append("usr/share/pixmaps/" + iconName + ".*");
+    if (!QDir::isAbsolutePath(metadata.iconPath))
+        patterns.append(metadata.iconPath + ".*");
+
+    return patterns;
+}
+
 void AppImageUtil::onExtractFinished(int exitCode, QProcess::ExitStatus status)
 {
-    if (status != QProcess::NormalExit || exitCode != 0) {
+    bool failed = status != QProcess::NormalExit || exitCode != 0;
+    const QString rootPath = m_tempExtractDir + "/squashfs-root";
+
+    if (m_process) {
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+
+    if (m_selectiveExtract) {
+        const bool hasDesktop = !QDir(rootPath).entryInfoList({"*.desktop"}, QDir::Files).isEmpty();
+
+        // Once the desktop file is there, a pattern without matches just moves on
+        if (!failed || hasDesktop) {
+            if (!m_extractPatterns.isEmpty()) {
+                startExtract(m_extractPatterns.takeFirst());
+                return;
+            }
+
+            if (!m_iconPatternsQueued && hasDesktop) {
+                m_iconPatternsQueued = true;
+                m_extractPatterns = iconExtractPatterns(rootPath);
+                if (!m_extractPatterns.isEmpty()) {
+                    startExtract(m_extractPatterns.takeFirst());
+                    return;
+                }
+            }
+        }
+
+        // Runtime without pattern support, or no desktop file, extract everything
+        if (!hasDesktop) {
+            m_selectiveExtract = false;
+            m_extractPatterns.clear();
+            QDir(rootPath).removeRecursively();
+            startExtract(QString());
+            return;
+        }
+
+        failed = false;
+    }
+
+    if (failed) {
         ErrorManager::instance()->reportError("AppImage does not support mount or extract.");
         unmountAppImage();
         emit mountFinished(false);
@@ -255,11 +457,20 @@ void AppImageUtil::onExtractFinished(int exitCode, QProcess::ExitStatus status)
 
 bool AppImageUtil::isMounted()
 {
-    return m_process && m_process->state() != QProcess::NotRunning && !m_mountPath.isEmpty();
+    if (m_mountPath.isEmpty())
+        return false;
+
+    // Extracted files stay available after the process is gone
+    return !m_tempExtractDir.isEmpty() || (m_process && m_process->state() != QProcess::NotRunning);
 }
 
 void AppImageUtil::unmountAppImage()
 {
+    if (m_mountWatcher) {
+        delete m_mountWatcher;
+        m_mountWatcher = nullptr;
+    }
+
     // Kill process
     if (m_process) {
         if (m_process->state() != QProcess::NotRunning) {
@@ -309,95 +520,58 @@ void AppImageUtil::unmountAppImage()
 
 const QString AppImageUtil::integratedDesktopPath(const QString& path)
 {
-    const QStringList searchPaths = getSearchPaths();
-
-    for (const QString& dirPath : searchPaths) {
-        QDir dir(dirPath);
-        const QStringList desktopFiles = dir.entryList(QStringList() << "*.desktop", QDir::Files);
-
-        for (const QString& fileName : desktopFiles) {
-            QString filePath = dir.absoluteFilePath(fileName);
-            QFile file(filePath);
-
-            if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-                continue;
-
-            QTextStream in(&file);
-            while (!in.atEnd()) {
-                QString line = in.readLine().trimmed();
-
-                if (line.startsWith("Exec=")) {
-                    QString execLine = line.mid(QString("Exec=").length());
-                    const QStringList execCommandParts = QProcess::splitCommand(execLine);
-
-                    for (const QString& execCommand : execCommandParts)
-                    {
-                        if (execCommand == path) {
-                            return filePath;
-                        }
-                    }
-                    break;
-                }
-            }
-        }
-    }
-    return QString();
+    return DesktopIndexUtil::lookup(path, getSearchPaths());
 }
 
-AppImageUtilMetadata AppImageUtil::metadata(MetadataAction action)
+QFuture<AppImageUtilMetadata> AppImageUtil::metadataAsync(MetadataAction action, int mountTimeoutMs)
 {
-    QFile file(m_path);
-    if (!file.open(QIODevice::ReadOnly)) {
-        throw std::runtime_error(("Failed to open file: " + m_path).toStdString());
-    }
+    auto promise = QSharedPointer<QPromise<AppImageUtilMetadata>>::create();
+    promise->start();
 
-    bool isValid = isAppImageType2(m_path);
-    // Currently only supporting appimage type 2
-    if(!isValid)
-    {
-        throw std::runtime_error("Invalid/unsupported appimage type");
-    }
+    const QString path = m_path;
+    QtConcurrent::run([path, action]() {
+        AppImageUtilMetadata metadata;
+        const bool needsMount = readBaseMetadata(path, action, metadata);
+        return qMakePair(needsMount, metadata);
+    }).then(this, [this, action, mountTimeoutMs, promise](QPair<bool, AppImageUtilMetadata> result) {
+        auto done = QSharedPointer<bool>::create(false);
+        auto finish = [this, action, promise, done, metadata = result.second](bool mounted) mutable {
+            if (*done)
+                return;
+            *done = true;
+
+            if (mounted)
+                readMountedMetadata(action, metadata);
+            readFallbackVersion(metadata);
+
+            promise->addResult(metadata);
+            promise->finish();
+        };
 
-    AppImageUtilMetadata metadata;
-    metadata.path = m_path;
-    metadata.type = 2;
-    metadata.executable = isExecutable(m_path);
+        if (!result.first || isMounted()) {
+            finish(isMounted());
+            return;
+        }
 
-    // If we the action is Register, we don't want to look at the integrated desktop file.
-    QString desktopPath = action != MetadataAction::Register ? integratedDesktopPath(m_path) : QString();
-    if(!desktopPath.isEmpty())
-    {
-        metadata.desktopFilePath = desktopPath;
-        parseDesktopPathForMetadata(desktopPath, metadata);
-    }
-    else if((metadata.executable && action == MetadataAction::Default) || action == MetadataAction::Register)
-    {
-        if(!isMounted())
-            mountAppImage();
+        connect(this, &AppImageUtil::mountFinished, this, finish, Qt::SingleShotConnection);
 
-        QString mountedDesktopPath = getMountedDesktopPath();
-        if (!mountedDesktopPath.isEmpty())
-        {
-            parseDesktopPathForMetadata(mountedDesktopPath, metadata, action == MetadataAction::Register);
-            metadata.iconPath = getMountedIconPath();
-        }
-    }
-    else
-    {
-        // The appimage is not executable, so we give it the name of the file
-        // and calculate the checksum.
-        QFileInfo fileInfo(m_path);
-        metadata.name = fileInfo.completeBaseName();
-        metadata.checksum = getChecksum(m_path);
-    }
+        QTimer::singleShot(mountTimeoutMs, this, [this, finish, done]() mutable {
+            // Extraction is allowed to take as long as it needs
+            if (*done || (m_process && !m_tempExtractDir.isEmpty()))
+                return;
 
-    if(metadata.executable && metadata.version.isEmpty())
-    {
-        auto md5 = getChecksum(m_path, QCryptographicHash::Md5);
-        metadata.version = md5.left(6);
-    }
+            ErrorManager::instance()->reportError("AppImage mount timed out.");
+            unmountAppImage();
+            finish(false);
+        });
+
+        mountAppImageAsync();
+    }).onFailed(this, [promise](const std::exception& e) {
+        promise->setException(std::make_exception_ptr(std::runtime_error(e.what())));
+        promise->finish();
+    });
 
-    return metadata;
+    return promise->future();
 }
 
 QString AppImageUtil::getMountedDesktopPath()
@@ -406,15 +580,9 @@ QString AppImageUtil::getMountedDesktopPath()
         return {};
 
     QDir mountDir(m_mountPath);
-
-    // Wait up to 1 second for the .desktop file
-    for (int i = 0; i < 20; ++i) {
-        QFileInfoList desktopFiles = mountDir.entryInfoList({"*.desktop"}, QDir::Files);
-        if (!desktopFiles.isEmpty())
-            return desktopFiles.first().absoluteFilePath();
-
-        QThread::msleep(50);
-    }
+    QFileInfoList desktopFiles = mountDir.entryInfoList({"*.desktop"}, QDir::Files);
+    if (!desktopFiles.isEmpty())
+        return desktopFiles.first().absoluteFilePath();
 
     return {};
 }
@@ -431,19 +599,12 @@ QString AppImageUtil::getMountedIconPath()
         parseDesktopPathForMetadata(mountedDesktopPath, metadata);
 
         // 1. Look for common image formats
-        QStringList filters = { "*.png", "*.svg", "*.xpm", "*.ico" };
-        QStringList iconDirs = {
-            m_mountPath + "/usr/share/icons/hicolor/scalable",
-            m_mountPath + "/usr/share/icons/hicolor/512x512",
-            m_mountPath + "/usr/share/icons/hicolor/256x256",
-            m_mountPath + "/usr/share/icons/hicolor/192x192",
-            m_mountPath + "/usr/share/icons/hicolor/128x128",
-            m_mountPath + "/usr/share/icons/hicolor/96x96",
-            m_mountPath + "/usr/share/icons/hicolor/64x64",
-            m_mountPath + "/usr/share/pixmaps"
-        };
+        QStringList filters;
+        for (const QString& ext : iconExtensions)
+            filters.append("*." + ext);
 
-        for (const QString& iconDirPath : iconDirs) {
+        for (const QString& iconDir : iconSearchDirs) {
+            const QString iconDirPath = m_mountPath + "/" + iconDir;
             if (!QDir(iconDirPath).exists())
                 continue;
 
@@ -459,8 +620,7 @@ QString AppImageUtil::getMountedIconPath()
 
         // 2: Absolute or relative path with extension
         QDir mountDir(m_mountPath);
-        QStringList imageExtensions = { "png", "svg", "xpm", "ico" };
-        for (const QString& ext : imageExtensions) {
+        for (const QString& ext : iconExtensions) {
             QString filename = metadata.iconPath + "." + ext;
             QFileInfo iconInfo(mountDir.filePath(filename));
             if (iconInfo.exists() && iconInfo.isFile()) {
@@ -485,87 +645,12 @@ QString AppImageUtil::getMountedIconPath()
     return QString();
 }
 
-QString AppImageUtil::registerAppImage()
+QFuture<QString> AppImageUtil::registerAppImageAsync()
 {
-    // Move/Copy appimage
-    AppImageUtilMetadata utilMetadata = metadata(MetadataAction::Register);
-    QString newAppImagePath = handleIntegrationFileOperation(utilMetadata.name);
-    if(newAppImagePath.isEmpty())
-    {
-        ErrorManager::instance()->reportError("Failed to move/copy appimage.");
-        return QString();
-    }
-
-    QString baseAppImageName = QFileInfo(newAppImagePath).completeBaseName();
-    QString newAppImageFolder = QFileInfo(newAppImagePath).absolutePath();
-
-    // If appimage path contains spaces, quote it
-    QString cleanNewAppImagePath = newAppImagePath;
-    if (cleanNewAppImagePath.contains('"'))
-        cleanNewAppImagePath.replace('"', "");
-
-    if(cleanNewAppImagePath.contains(' '))
-        cleanNewAppImagePath = "\"" + cleanNewAppImagePath + "\"";
-
-    // Copy icon
-    QString mountedIconPath = getMountedIconPath();
-    QFileInfo mountedIconInfo(mountedIconPath);
-    QString newIconFileName = baseAppImageName;
-    if (!mountedIconInfo.suffix().isEmpty()) {
-        newIconFileName += "." + mountedIconInfo.suffix();
-    }
-    QString newIconPath = QDir(newAppImageFolder).filePath(".icons/" + newIconFileName);
-    QDir().mkpath(QFileInfo(newIconPath).absolutePath());
-    bool imageSuccess = QFile::copy(mountedIconPath, newIconPath);
-    if(!imageSuccess)
-    {
-        ErrorManager::instance()->reportError("Failed to create icon");
-    }
-    QString cleanNewIconPath = newIconPath;
-    if (cleanNewIconPath.contains('"'))
-        cleanNewIconPath.replace('"', "");
-
-    // Add integration meta
-    QString newDesktopContent = utilMetadata.mountedDesktopContents;
-    if (!newDesktopContent.endsWith('\n'))
-        newDesktopContent += '\n';
-    newDesktopContent += balIntegrationField + '\n';
-
-    // Replace Exec/TryExec/Icon
-    QStringList lines = newDesktopContent.split('\n');
-    for (QString& line : lines) {
-        if(line.startsWith("Exec="))
-        {
-            line = parseExecLine(line, newAppImagePath);
-        }
-        else if(line.startsWith("TryExec="))
-        {
-            line = QString("TryExec=%1").arg(cleanNewAppImagePath);
-        }
-        else if(line.startsWith("Icon="))
-        {
-            line = QString("Icon=%1").arg(cleanNewIconPath);
-        }
-    }
-    newDesktopContent = lines.join('\n');
-
-    QString newDesktopFileName = baseAppImageName + ".desktop";
-    QString newDesktopPath = QDir(getLocalIntegrationPath()).filePath(newDesktopFileName);
-
-    // Ensure directory exists
-    QDir().mkpath(QFileInfo(newDesktopPath).absolutePath());
-
-    QFile file(newDesktopPath);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
-        QTextStream out(&file);
-        out << newDesktopContent;
-        file.close();
-    } else {
-        ErrorManager::instance()->reportError(QString("Failed to create deskop entry: %1").arg(file.errorString()));
-        return QString();
-    }
-
-    return newAppImagePath;
+    // The appimage stays mounted until the util is gone, so the icon can be copied from it
+    return metadataAsync(MetadataAction::Register).then(QtFuture::Launch::Async, [this](AppImageUtilMetadata utilMetadata) {
+        return registerAppImage(utilMetadata);
+    });
 }
 
 bool AppImageUtil::unregisterAppImage(bool deleteAppImage)
@@ -575,53 +660,84 @@ bool AppImageUtil::unregisterAppImage(bool deleteAppImage)
         return false;
     }
 
-    AppImageUtilMetadata utilMetadata = metadata(MetadataAction::Unregister);
+    // Registered appimages are read from their integrated desktop file, nothing to mount
+    AppImageUtilMetadata utilMetadata;
+    readBaseMetadata(m_path, MetadataAction::Unregister, utilMetadata);
 
     if (!removeFileOrWarn(utilMetadata.iconPath, "icon file")) return false;
     if (!removeFileOrWarn(utilMetadata.desktopFilePath, "desktop file")) return false;
+    DesktopIndexUtil::invalidate();
     if (deleteAppImage && !removeFileOrWarn(utilMetadata.path, "AppImage file")) return false;
 
     return true;
 }
 
-const QList<AppImageUtilMetadata> AppImageUtil::getRegisteredList()
+QFuture<AppImageUtilMetadata> AppImageUtil::getRegisteredListAsync(std::function<void(AppImageUtilMetadata&)> process)
 {
-    QList<AppImageUtilMetadata> list;
     QDir dir(SettingsManager::instance()->appImageDefaultLocation().toLocalFile());
     const QFileInfoList files = dir.entryInfoList(
         QStringList() << "*.AppImage" << "*.appimage",
         QDir::Files | QDir::NoSymLinks
         );
 
+    // Build/validate the desktop index once for the whole list
+    const QHash<QString, QString> desktopIndex = DesktopIndexUtil::index(getSearchPaths());
+
+    QList<QPair<QString, QString>> entries;
+    QStringList paths;
     for (const QFileInfo &fileInfo : files)
     {
         QString path = fileInfo.absoluteFilePath();
-        QString desktopPath = integratedDesktopPath(path);
+        QString desktopPath = desktopIndex.value(path);
 
         if(!desktopPath.isEmpty())
         {
-            AppImageUtilMetadata utilMetadata;
-            utilMetadata.path = path;
-            utilMetadata.type = isAppImageType2(path) ? 2 : 1;
-            utilMetadata.desktopFilePath = desktopPath;
-            parseDesktopPathForMetadata(desktopPath, utilMetadata);
-
-            if(utilMetadata.version.isEmpty())
-            {
-                auto md5 = getChecksum(path, QCryptographicHash::Md5);
-                utilMetadata.version = md5.left(6);
-            }
-
-            list.append(utilMetadata);
+            entries.append({path, desktopPath});
+            paths.append(path);
         }
     }
 
-    return list;
-}
+    MetadataCacheUtil::retain(paths);
 
-const bool AppImageUtil::saveUpdaterSettings(const QString& desktopFilePath,
-                                             const QString& updaterType,
-                                             const UpdaterSettings& settings)
+    // Each appimage is parsed, fingerprinted and post processed by its own task,
+    // the pool size bounds how many are in flight
+    QFuture<AppImageUtilMetadata> future = QtConcurrent::mapped(entries, [process](const QPair<QString, QString>& entry) {
+        AppImageUtilMetadata utilMetadata = loadRegisteredMetadata(entry.first, entry.second);
+        if (process)
+            process(utilMetadata);
+        return utilMetadata;
+    });
+
+    future.then(QtFuture::Launch::Async, [](QFuture<AppImageUtilMetadata>) {
+        MetadataCacheUtil::save();
+    });
+
+    return future;
+}
+
+const AppImageUtilMetadata AppImageUtil::getRegisteredMetadata(const QString& path)
+{
+    const QString desktopPath = DesktopIndexUtil::lookup(path, getSearchPaths());
+    if (desktopPath.isEmpty() || !QFileInfo(path).isFile())
+        return AppImageUtilMetadata();
+
+    AppImageUtilMetadata utilMetadata = loadRegisteredMetadata(path, desktopPath);
+    MetadataCacheUtil::save();
+    return utilMetadata;
+}
+
+const QStringList AppImageUtil::getSearchPaths()
+{
+    return {
+        "/usr/share/applications",
+        "/usr/local/share/applications",
+        QDir::homePath() + "/.local/share/applications"
+    };
+}
+
+const bool AppImageUtil::saveUpdaterSettings(const QString& desktopFilePath,
+                                             const QString& updaterType,
+                                             const UpdaterSettings& settings)
 {
     if (!QFile::exists(desktopFilePath)) {
         ErrorManager::instance()->reportError("Desktop file does not exist: " + desktopFilePath);
@@ -736,99 +852,46 @@ const bool AppImageUtil::saveUpdaterSettings(const QString& desktopFilePath,
     QTextStream out(&file);
     out << newLines.join("\n") << "\n";
     file.close();
+    DesktopIndexUtil::invalidate();
 
     return true;
 }
 
-const bool AppImageUtil::refreshDesktopFile(const QString& appImagePath, const QString& updateVersion, const QString& updateDate)
+QFuture<bool> AppImageUtil::refreshDesktopFileAsync(const QString& appImagePath, const QString& updateVersion,
+                                                    const QString& updateDate, int mountTimeoutMs)
 {
-    // Integrated Desktop Contents
-    QString desktopPath = integratedDesktopPath(appImagePath);
-    if(desktopPath.isEmpty()) {
-        ErrorManager::instance()->reportError("Failed to find integrated desktop file for: " + appImagePath);
-        return false;
-    }
-    AppImageUtilMetadata intMetadata;
-    parseDesktopPathForMetadata(desktopPath, intMetadata, true);
+    auto promise = QSharedPointer<QPromise<bool>>::create();
+    promise->start();
 
-    // AppImage Desktop Contents
-    AppImageUtil util(appImagePath);
-    util.mountAppImage();
-    AppImageUtilMetadata metadata;
-    QString mountedDesktopPath = util.getMountedDesktopPath();
-    QString mountedIconPath = util.getMountedIconPath();
-    if(mountedDesktopPath.isEmpty()) {
-        ErrorManager::instance()->reportError("Failed to find mounted desktop file for: " + appImagePath);
-        return false;
-    }
-    parseDesktopPathForMetadata(mountedDesktopPath, metadata, true);
-
-    // Copy new icon
-    if(!mountedIconPath.isEmpty())
-    {
-        QSettings desktopFile(desktopPath, QSettings::IniFormat);
-        desktopFile.beginGroup("Desktop Entry");
-        QString iconPath = desktopFile.value("Icon").toString();
-        desktopFile.endGroup();
-
-        QFile::remove(iconPath);
-        QFile::copy(mountedIconPath, iconPath);
-    }
-
-    util.unmountAppImage();
-
-    QString desktopContents = intMetadata.mountedDesktopContents;
-    QString mountedDesktopContents = metadata.mountedDesktopContents;
-
-    // parse exec line
-    QStringList lines = mountedDesktopContents.split('\n');
-    for (QString& line : lines) {
-        if(line.startsWith("Exec="))
-        {
-            line = parseExecLine(line, appImagePath);
-        }
-    }
-    mountedDesktopContents = lines.join('\n');
-
-    updateDesktopKey(desktopContents, mountedDesktopContents, "Exec");
-    updateDesktopKey(desktopContents, mountedDesktopContents, "Name");
-    updateDesktopKey(desktopContents, mountedDesktopContents, "Comment");
-    updateDesktopKey(desktopContents, mountedDesktopContents, "Categories");
-    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateType");
-    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateUrl");
-    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateDownloadField");
-    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateDownloadPattern");
-    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateDateField");
-    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateVersionField");
-    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateVersionPattern");
-    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateFilters");
-    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateCurrentVersion");
-    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateCurrentDate");
+    auto* util = new AppImageUtil(appImagePath);
+    auto done = QSharedPointer<bool>::create(false);
+    auto finish = [util, promise, done, updateVersion, updateDate](bool mounted) {
+        if (*done)
+            return;
+        *done = true;
 
-    QString fallbackVersion = updateVersion;
-    if(fallbackVersion.isEmpty())
-    {
-        auto md5 = getChecksum(appImagePath, QCryptographicHash::Md5);
-        fallbackVersion = md5.left(6);
-    }
+        const bool success = mounted && refreshDesktopFile(*util, updateVersion, updateDate);
+        util->unmountAppImage();
+        util->deleteLater();
 
-    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-Version", fallbackVersion);
+        promise->addResult(success);
+        promise->finish();
+    };
 
-    if (!updateVersion.isEmpty())
-        updateDesktopKey(desktopContents, QString("X-AppImage-BAL-UpdateCurrentVersion=" + updateVersion), "X-AppImage-BAL-UpdateCurrentVersion");
-    if (!updateDate.isEmpty())
-        updateDesktopKey(desktopContents, QString("X-AppImage-BAL-UpdateCurrentDate=" + updateDate), "X-AppImage-BAL-UpdateCurrentDate");
+    connect(util, &AppImageUtil::mountFinished, util, finish, Qt::SingleShotConnection);
 
-    QFile outFile(desktopPath);
-    if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-        ErrorManager::instance()->reportError("Failed to write updated desktop file: " + desktopPath);
-        return false;
-    }
+    QTimer::singleShot(mountTimeoutMs, util, [util, finish, done]() {
+        // Extraction is allowed to take as long as it needs
+        if (*done || (util->m_process && !util->m_tempExtractDir.isEmpty()))
+            return;
 
-    outFile.write(desktopContents.toUtf8());
-    outFile.close();
+        ErrorManager::instance()->reportError("AppImage mount timed out.");
+        util->unmountAppImage();
+        finish(false);
+    });
 
-    return true;
+    util->mountAppImageAsync();
+    return promise->future();
 }
 
 void AppImageUtil::updateAppImage(const QString& appImagePath, const QString& downloadUrl,
@@ -863,42 +926,70 @@ void AppImageUtil::updateAppImage(const QString& appImagePath, const QString& do
             }, Qt::QueuedConnection);
     };
 
-    QNetworkReply* reply = NetworkUtil::networkManager()->get(QNetworkRequest(QUrl(downloadUrl)));
+    const QString partPath = appImagePath + ".new.part";
+    const QString newPath = appImagePath + ".new";
+    const QUrl url(downloadUrl);
+    const bool zsync = url.path().endsWith(".zsync", Qt::CaseInsensitive);
 
-    if (progressCallback) {
-        QObject::connect(reply, &QNetworkReply::downloadProgress, [invokeProgress](qint64 received, qint64 total) {
-            invokeProgress(UpdateState::Downloading, received, total);
-        });
-    }
+    // Extraction can only follow a download that starts from an empty file and writes it in order
+    const bool streaming = !zsync && !QFile::exists(partPath);
+    auto stream = QSharedPointer<DownloadStream>::create();
+    auto streamed = QSharedPointer<QFuture<bool>>::create();
+    QFile::remove(newPath);
 
-    QObject::connect(reply, &QNetworkReply::finished, [=]() {
-        if (reply->error() != QNetworkReply::NoError) {
-            ErrorManager::instance()->reportError(
-                "Download failed: " + reply->errorString());
-            reply->deleteLater();
-            invokeProgress(UpdateState::Failed);
-            invokeFinished(false);
-            return;
+    auto onDownloaded = [=](bool downloaded) {
+        {
+            QMutexLocker locker(&stream->mutex);
+            stream->finished = true;
+            stream->downloaded = downloaded;
+            stream->changed.wakeAll();
         }
 
-        QByteArray data = reply->readAll();
-        reply->deleteLater();
+        if (!downloaded) {
+            // Extraction may have written part of the appimage already, remove it once the
+            // extractor has stopped and only then report, so a retry cannot lose its file
+            auto fail = [newPath, invokeProgress, invokeFinished](bool) {
+                QFile::remove(newPath);
+                invokeProgress(UpdateState::Failed);
+                invokeFinished(false);
+            };
+
+            if (streamed->isValid())
+                streamed->then(fail);
+            else
+                fail(false);
+            return;
+        }
 
         invokeProgress(UpdateState::Extracting);
 
         // Move heavy work off the UI thread
-        QThreadPool::globalInstance()->start([data = std::move(data), appImagePath, version, date, invokeProgress, invokeFinished]() {
+        QThreadPool::globalInstance()->start([partPath, newPath, appImagePath, version, date, streamed, invokeProgress, invokeFinished]() {
             bool success = false;
-            QString newPath = appImagePath + ".new";
 
-            if (ArchiveUtil::isZip(data)) {
-                success = ArchiveUtil::extractAppImageFromZip(data, newPath);
+            if (streamed->isValid() && streamed->result()) {
+                // Already extracted while downloading
+                success = true;
+                QFile::remove(partPath);
             } else {
-                QFile newFile(newPath);
-                if (newFile.open(QIODevice::WriteOnly)) {
-                    newFile.write(data);
-                    newFile.close();
-                    success = true;
+                QFile::remove(newPath);
+
+                // Sniff the first bytes to detect a zipped appimage
+                QByteArray magic;
+                QFile partFile(partPath);
+                if (partFile.open(QIODevice::ReadOnly)) {
+                    magic = partFile.read(4);
+                    partFile.close();
+                }
+
+                if (ArchiveUtil::isZip(magic)) {
+                    success = ArchiveUtil::extractAppImageFromZipFile(partPath, newPath);
+                    QFile::remove(partPath);
+                    // Do not leave a truncated appimage behind
+                    if (!success)
+                        QFile::remove(newPath);
+                } else {
+                    success = QFile::rename(partPath, newPath);
                 }
             }
 
@@ -916,14 +1007,44 @@ void AppImageUtil::updateAppImage(const QString& appImagePath, const QString& do
                 success = QFile::rename(newPath, appImagePath);
             }
 
-            if (!refreshDesktopFile(appImagePath, version, date)) {
-                success = false;
-            }
+            // The mount is driven by signals, so it runs on the UI thread instead of
+            // parking this pool thread in a nested event loop
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [=]() {
+                refreshDesktopFileAsync(appImagePath, version, date).then(QCoreApplication::instance(), [=](bool refreshed) {
+                    const bool updated = success && refreshed;
+                    invokeProgress(updated ? UpdateState::Success : UpdateState::Failed);
+                    invokeFinished(updated);
+                });
+            }, Qt::QueuedConnection);
+        });
+    };
+
+    auto onProgress = [invokeProgress, stream](qint64 received, qint64 total) {
+        {
+            QMutexLocker locker(&stream->mutex);
+            // Received going backwards means the part file was truncated and started over
+            if (received < stream->received)
+                stream->restarted = true;
+            stream->received = received;
+            stream->changed.wakeAll();
+        }
 
-            invokeProgress(success ? UpdateState::Success : UpdateState::Failed);
-            invokeFinished(success);
+        invokeProgress(UpdateState::Downloading, received, total);
+    };
+
+    // A zsync control file lets us reuse the blocks of the current appimage
+    if (zsync) {
+        ZsyncUtil::download(url, appImagePath, partPath, onDownloaded, onProgress);
+    } else {
+        DownloadUtil::download(url, partPath, onDownloaded, onProgress);
+    }
+
+    // A zipped appimage is extracted as it arrives instead of after the download
+    if (streaming && QFile::exists(partPath)) {
+        *streamed = QtConcurrent::run(streamPool(), [partPath, newPath, stream]() {
+            return extractZipFromDownload(partPath, newPath, stream);
         });
-    });
+    }
 }
 
 // ----------------- Private -----------------
@@ -931,6 +1052,224 @@ void AppImageUtil::updateAppImage(const QString& appImagePath, const QString& do
 const QRegularExpression AppImageUtil::execLineRegex(R"(^Exec=(?:env\s+((?:\S+=\S+\s?)*))?(".*?"|\S+)(?:\s+([^\n\r]*))?$)");
 const QRegularExpression AppImageUtil::invalidChars(R"([/\\:*?"<>|])");
 const QString AppImageUtil::balIntegrationField = "X-AppImage-BAL=true";
+const QStringList AppImageUtil::iconSearchDirs = {
+    "usr/share/icons/hicolor/scalable",
+    "usr/share/icons/hicolor/512x512",
+    "usr/share/icons/hicolor/256x256",
+    "usr/share/icons/hicolor/192x192",
+    "usr/share/icons/hicolor/128x128",
+    "usr/share/icons/hicolor/96x96",
+    "usr/share/icons/hicolor/64x64",
+    "usr/share/pixmaps"
+};
+const QStringList AppImageUtil::iconExtensions = { "png", "svg", "xpm", "ico" };
+
+bool AppImageUtil::extractFromSquashfs()
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 payloadOffset = getPayloadOffset(file);
+    file.close();
+    if (payloadOffset <= 0)
+        return false;
+
+    SquashfsUtil squashfs(m_path, payloadOffset);
+    if (!squashfs.open())
+        return false;
+
+    // Root desktop file, in the same order a directory listing would give
+    QStringList desktopNames;
+    for (const SquashfsEntry& entry : squashfs.entries(QString())) {
+        if (entry.type != SquashfsEntry::Directory && entry.name.endsWith(".desktop"))
+            desktopNames.append(entry.name);
+    }
+    if (desktopNames.isEmpty())
+        return false;
+    desktopNames.sort();
+
+    QString tempDir = QDir::tempPath() + "/appimage-" + QUuid::createUuid().toString();
+    if (!QDir().mkpath(tempDir))
+        return false;
+
+    // Files keep their path inside the image so the mounted lookups work unchanged
+    auto extract = [&](const QString& path) {
+        const QString cleanPath = QDir::cleanPath(path);
+        if (cleanPath.isEmpty() || cleanPath.startsWith('/') || cleanPath.startsWith(".."))
+            return false;
+
+        const QString outputPath = tempDir + "/" + cleanPath;
+        QDir().mkpath(QFileInfo(outputPath).absolutePath());
+        return squashfs.extractFile(cleanPath, outputPath);
+    };
+
+    const QString desktopPath = tempDir + "/" + desktopNames.first();
+    if (!extract(desktopNames.first())) {
+        QDir(tempDir).removeRecursively();
+        return false;
+    }
+
+    // .DirIcon is usually a symlink, keep it one so the icon keeps its suffix
+    const QString dirIconPath = squashfs.canonicalPath(".DirIcon");
+    if (dirIconPath == ".DirIcon") {
+        extract(dirIconPath);
+    } else if (!dirIconPath.isEmpty() && extract(dirIconPath)) {
+        QFile::link(tempDir + "/" + dirIconPath, tempDir + "/.DirIcon");
+    }
+
+    AppImageUtilMetadata desktopMetadata;
+    parseDesktopPathForMetadata(desktopPath, desktopMetadata);
+    const QString iconName = QFileInfo(desktopMetadata.iconPath).completeBaseName();
+
+    // Only the first icon the mounted lookup would pick is extracted
+    std::function<bool(const QString&)> findIcon = [&](const QString& dirPath) {
+        for (const SquashfsEntry& entry : squashfs.entries(dirPath)) {
+            const QString entryPath = dirPath + "/" + entry.name;
+            if (entry.type == SquashfsEntry::Directory) {
+                if (findIcon(entryPath))
+                    return true;
+            } else if (entry.type == SquashfsEntry::File
+                       && iconExtensions.contains(QFileInfo(entry.name).suffix(), Qt::CaseInsensitive)
+                       && QFileInfo(entry.name).completeBaseName() == iconName) {
+                return extract(entryPath);
+            }
+        }
+        return false;
+    };
+
+    if (!iconName.isEmpty()) {
+        bool found = false;
+        for (const QString& iconDir : iconSearchDirs) {
+            if (findIcon(iconDir)) {
+                found = true;
+                break;
+            }
+        }
+
+        if (!found) {
+            for (const QString& ext : iconExtensions) {
+                if (extract(desktopMetadata.iconPath + "." + ext))
+                    break;
+            }
+        }
+    }
+
+    m_tempExtractDir = tempDir;
+    m_mountPath = tempDir;
+    return true;
+}
+
+const qint64 AppImageUtil::getPayloadOffset(QIODevice& device)
+{
+    // The payload starts right after the ELF runtime, which ends with its section header table
+    if (!device.seek(0))
+        return -1;
+
+    const QByteArray header = device.read(64);
+    if (header.size() < 52 || !header.startsWith("\x7f" "ELF"))
+        return -1;
+
+    const bool is64 = header.at(4) == 2;
+    const bool isLittleEndian = header.at(5) == 1;
+    auto readUInt = [&](int offset, int length) -> quint64 {
+        if (offset + length > header.size())
+            return 0;
+        quint64 value = 0;
+        for (int i = 0; i < length; ++i) {
+            int index = isLittleEndian ? offset + length - 1 - i : offset + i;
+            value = (value << 8) | static_cast<quint8>(header.at(index));
+        }
+        return value;
+    };
+
+    quint64 sectionHeaderOffset = is64 ? readUInt(0x28, 8) : readUInt(0x20, 4);
+    quint64 sectionHeaderSize = is64 ? readUInt(0x3A, 2) : readUInt(0x2E, 2);
+    quint64 sectionHeaderCount = is64 ? readUInt(0x3C, 2) : readUInt(0x30, 2);
+
+    return static_cast<qint64>(sectionHeaderOffset + sectionHeaderSize * sectionHeaderCount);
+}
+
+const bool AppImageUtil::readBaseMetadata(const QString& path, MetadataAction action, AppImageUtilMetadata& metadata)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error(("Failed to open file: " + path).toStdString());
+    }
+
+    bool isValid = isAppImageType2(path);
+    // Currently only supporting appimage type 2
+    if(!isValid)
+    {
+        throw std::runtime_error("Invalid/unsupported appimage type");
+    }
+
+    metadata.path = path;
+    metadata.type = 2;
+    metadata.executable = isExecutable(path);
+
+    // If we the action is Register, we don't want to look at the integrated desktop file.
+    QString desktopPath = action != MetadataAction::Register ? integratedDesktopPath(path) : QString();
+    if(!desktopPath.isEmpty())
+    {
+        metadata.desktopFilePath = desktopPath;
+        parseDesktopPathForMetadata(desktopPath, metadata);
+    }
+    else if((metadata.executable && action == MetadataAction::Default) || action == MetadataAction::Register)
+    {
+        return true;
+    }
+    else
+    {
+        // The appimage is not executable, so we give it the name of the file
+        // and calculate the checksum.
+        QFileInfo fileInfo(path);
+        metadata.name = fileInfo.completeBaseName();
+        metadata.checksum = getChecksum(path);
+    }
+
+    return false;
+}
+
+void AppImageUtil::readMountedMetadata(MetadataAction action, AppImageUtilMetadata& metadata)
+{
+    QString mountedDesktopPath = getMountedDesktopPath();
+    if (!mountedDesktopPath.isEmpty())
+    {
+        parseDesktopPathForMetadata(mountedDesktopPath, metadata, action == MetadataAction::Register);
+        metadata.iconPath = getMountedIconPath();
+    }
+}
+
+void AppImageUtil::readFallbackVersion(AppImageUtilMetadata& metadata)
+{
+    if(metadata.executable && metadata.version.isEmpty())
+    {
+        metadata.version = getFingerprint(metadata.path).left(6);
+    }
+}
+
+const AppImageUtilMetadata AppImageUtil::loadRegisteredMetadata(const QString& path, const QString& desktopPath)
+{
+    // Reuse the cached metadata if neither the appimage nor its desktop file changed
+    MetadataCacheStamp stamp = MetadataCacheUtil::stamp(path, desktopPath);
+    AppImageUtilMetadata utilMetadata;
+    if (MetadataCacheUtil::lookup(path, stamp, utilMetadata))
+        return utilMetadata;
+
+    utilMetadata.path = path;
+    utilMetadata.type = isAppImageType2(path) ? 2 : 1;
+    utilMetadata.desktopFilePath = desktopPath;
+    parseDesktopPathForMetadata(desktopPath, utilMetadata);
+
+    if(utilMetadata.version.isEmpty())
+    {
+        utilMetadata.version = getFingerprint(path).left(6);
+    }
+
+    MetadataCacheUtil::insert(path, stamp, utilMetadata);
+    return utilMetadata;
+}
 
 const QString AppImageUtil::escapeDesktopValue(const QString &value)
 {
@@ -1075,15 +1414,6 @@ QString AppImageUtil::handleIntegrationFileOperation(QString appName)
     return success ? newPath : QString();
 }
 
-const QStringList AppImageUtil::getSearchPaths()
-{
-    return {
-        "/usr/share/applications",
-        "/usr/local/share/applications",
-        QDir::homePath() + "/.local/share/applications"
-    };
-}
-
 const QString AppImageUtil::getLocalIntegrationPath()
 {
     return QDir::homePath() + "/.local/share/applications";
@@ -1107,8 +1437,8 @@ void AppImageUtil::updateDesktopKey(QString& targetContents,
                                           const QString& key,
                                           const QString& fallback)
 {
-    QRegularExpression rx("^" + QRegularExpression::escape(key) + R"(=.+$)",
-                          QRegularExpression::MultilineOption);
+    const QRegularExpression rx = RegexUtil::get("^" + QRegularExpression::escape(key) + R"(=.+$)",
+                                                 QRegularExpression::MultilineOption);
 
     QRegularExpressionMatch match = rx.match(sourceContents);
     QString lineToUse;
@@ -1127,15 +1457,15 @@ void AppImageUtil::updateDesktopKey(QString& targetContents,
         targetContents.replace(rx, lineToUse);
     } else {
         // Insert into [Desktop Entry] section or append
-        QRegularExpression entryRx(R"(^\[Desktop Entry\])",
-                                   QRegularExpression::MultilineOption);
+        const QRegularExpression entryRx = RegexUtil::get(R"(^\[Desktop Entry\])",
+                                                          QRegularExpression::MultilineOption);
         QRegularExpressionMatch entryMatch = entryRx.match(targetContents);
         if (entryMatch.hasMatch()) {
             int sectionStart = entryMatch.capturedEnd();
 
             // Find the start of the next section
-            QRegularExpression nextSectionRx(R"(^\s*\[[^\]]+\].*$)",
-                                             QRegularExpression::MultilineOption);
+            const QRegularExpression nextSectionRx = RegexUtil::get(R"(^\s*\[[^\]]+\].*$)",
+                                                                    QRegularExpression::MultilineOption);
             QRegularExpressionMatch nextMatch = nextSectionRx.match(targetContents, sectionStart);
 
             int insertPos = nextMatch.hasMatch()
@@ -1190,3 +1520,175 @@ const QString AppImageUtil::parseExecLine(const QString& line, const QString& ap
 
     return line;
 }
+
+const bool AppImageUtil::refreshDesktopFile(AppImageUtil& util, const QString& updateVersion, const QString& updateDate)
+{
+    const QString appImagePath = util.m_path;
+
+    // Integrated Desktop Contents
+    QString desktopPath = integratedDesktopPath(appImagePath);
+    if(desktopPath.isEmpty()) {
+        ErrorManager::instance()->reportError("Failed to find integrated desktop file for: " + appImagePath);
+        return false;
+    }
+    AppImageUtilMetadata intMetadata;
+    parseDesktopPathForMetadata(desktopPath, intMetadata, true);
+
+    // AppImage Desktop Contents, the caller mounted it
+    AppImageUtilMetadata metadata;
+    QString mountedDesktopPath = util.getMountedDesktopPath();
+    QString mountedIconPath = util.getMountedIconPath();
+    if(mountedDesktopPath.isEmpty()) {
+        ErrorManager::instance()->reportError("Failed to find mounted desktop file for: " + appImagePath);
+        return false;
+    }
+    parseDesktopPathForMetadata(mountedDesktopPath, metadata, true);
+
+    // Copy new icon
+    if(!mountedIconPath.isEmpty())
+    {
+        QSettings desktopFile(desktopPath, QSettings::IniFormat);
+        desktopFile.beginGroup("Desktop Entry");
+        QString iconPath = desktopFile.value("Icon").toString();
+        desktopFile.endGroup();
+
+        QFile::remove(iconPath);
+        QFile::copy(mountedIconPath, iconPath);
+    }
+
+    QString desktopContents = intMetadata.mountedDesktopContents;
+    QString mountedDesktopContents = metadata.mountedDesktopContents;
+
+    // parse exec line
+    QStringList lines = mountedDesktopContents.split('\n');
+    for (QString& line : lines) {
+        if(line.startsWith("Exec="))
+        {
+            line = parseExecLine(line, appImagePath);
+        }
+    }
+    mountedDesktopContents = lines.join('\n');
+
+    updateDesktopKey(desktopContents, mountedDesktopContents, "Exec");
+    updateDesktopKey(desktopContents, mountedDesktopContents, "Name");
+    updateDesktopKey(desktopContents, mountedDesktopContents, "Comment");
+    updateDesktopKey(desktopContents, mountedDesktopContents, "Categories");
+    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateType");
+    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateUrl");
+    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateDownloadField");
+    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateDownloadPattern");
+    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateDateField");
+    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateVersionField");
+    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateVersionPattern");
+    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateFilters");
+    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateCurrentVersion");
+    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-BAL-UpdateCurrentDate");
+
+    QString fallbackVersion = updateVersion;
+    if(fallbackVersion.isEmpty())
+    {
+        fallbackVersion = getFingerprint(appImagePath).left(6);
+    }
+
+    updateDesktopKey(desktopContents, mountedDesktopContents, "X-AppImage-Version", fallbackVersion);
+
+    if (!updateVersion.isEmpty())
+        updateDesktopKey(desktopContents, QString("X-AppImage-BAL-UpdateCurrentVersion=" + updateVersion), "X-AppImage-BAL-UpdateCurrentVersion");
+    if (!updateDate.isEmpty())
+        updateDesktopKey(desktopContents, QString("X-AppImage-BAL-UpdateCurrentDate=" + updateDate), "X-AppImage-BAL-UpdateCurrentDate");
+
+    QFile outFile(desktopPath);
+    if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        ErrorManager::instance()->reportError("Failed to write updated desktop file: " + desktopPath);
+        return false;
+    }
+
+    outFile.write(desktopContents.toUtf8());
+    outFile.close();
+    DesktopIndexUtil::invalidate();
+
+    return true;
+}
+
+QString AppImageUtil::registerAppImage(const AppImageUtilMetadata& utilMetadata)
+{
+    // Move/Copy appimage
+    QString newAppImagePath = handleIntegrationFileOperation(utilMetadata.name);
+    if(newAppImagePath.isEmpty())
+    {
+        ErrorManager::instance()->reportError("Failed to move/copy appimage.");
+        return QString();
+    }
+
+    QString baseAppImageName = QFileInfo(newAppImagePath).completeBaseName();
+    QString newAppImageFolder = QFileInfo(newAppImagePath).absolutePath();
+
+    // If appimage path contains spaces, quote it
+    QString cleanNewAppImagePath = newAppImagePath;
+    if (cleanNewAppImagePath.contains('"'))
+        cleanNewAppImagePath.replace('"', "");
+
+    if(cleanNewAppImagePath.contains(' '))
+        cleanNewAppImagePath = "\"" + cleanNewAppImagePath + "\"";
+
+    // Copy icon
+    QString mountedIconPath = getMountedIconPath();
+    QFileInfo mountedIconInfo(mountedIconPath);
+    QString newIconFileName = baseAppImageName;
+    if (!mountedIconInfo.suffix().isEmpty()) {
+        newIconFileName += "." + mountedIconInfo.suffix();
+    }
+    QString newIconPath = QDir(newAppImageFolder).filePath(".icons/" + newIconFileName);
+    QDir().mkpath(QFileInfo(newIconPath).absolutePath());
+    bool imageSuccess = QFile::copy(mountedIconPath, newIconPath);
+    if(!imageSuccess)
+    {
+        ErrorManager::instance()->reportError("Failed to create icon");
+    }
+    QString cleanNewIconPath = newIconPath;
+    if (cleanNewIconPath.contains('"'))
+        cleanNewIconPath.replace('"', "");
+
+    // Add integration meta
+    QString newDesktopContent = utilMetadata.mountedDesktopContents;
+    if (!newDesktopContent.endsWith('\n'))
+        newDesktopContent += '\n';
+    newDesktopContent += balIntegrationField + '\n';
+
+    // Replace Exec/TryExec/Icon
+    QStringList lines = newDesktopContent.split('\n');
+    for (QString& line : lines) {
+        if(line.startsWith("Exec="))
+        {
+            line = parseExecLine(line, newAppImagePath);
+        }
+        else if(line.startsWith("TryExec="))
+        {
+            line = QString("TryExec=%1").arg(cleanNewAppImagePath);
+        }
+        else if(line.startsWith("Icon="))
+        {
+            line = QString("Icon=%1").arg(cleanNewIconPath);
+        }
+    }
+    newDesktopContent = lines.join('\n');
+
+    QString newDesktopFileName = baseAppImageName + ".desktop";
+    QString newDesktopPath = QDir(getLocalIntegrationPath()).filePath(newDesktopFileName);
+
+    // Ensure directory exists
+    QDir().mkpath(QFileInfo(newDesktopPath).absolutePath());
+
+    QFile file(newDesktopPath);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        QTextStream out(&file);
+        out << newDesktopContent;
+        file.close();
+        DesktopIndexUtil::invalidate();
+    } else {
+        ErrorManager::instance()->reportError(QString("Failed to create deskop entry: %1").arg(file.errorString()));
+        return QString();
+    }
+
+    return newAppImagePath;
+}
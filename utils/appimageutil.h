@@ -4,6 +4,8 @@
 #include "utils/updater/updaterfactory.h"
 
 #include <QCryptographicHash>
+#include <QFileSystemWatcher>
+#include <QFuture>
 #include <QProcess>
 #include <QString>
 
@@ -71,6 +73,14 @@ public:
      * @return Checksum of the file at path
      */
     static const QString getChecksum(const QString& path, const QCryptographicHash::Algorithm hashType = QCryptographicHash::Sha256);
+    /**
+     * @brief Gets a cheap content fingerprint of the appimage. Only the ELF header,
+     * the squashfs superblock and a few sampled blocks are hashed together with
+     * the file size, so it costs kilobytes of I/O regardless of the file size.
+     * @param path Path to the appimage
+     * @return Hex fingerprint of the appimage, or empty on failure
+     */
+    static const QString getFingerprint(const QString& path);
     /**
      * @brief Checks if the path is executable
      * @param path Path to file to check is executable
@@ -83,10 +93,9 @@ public:
      */
     static const bool makeExecutable(const QString& path);
     /**
-     * @brief Mounts an appimage
-     * and process. The process must be cleaned up using unmountAppImage(...)
+     * @brief Mounts an appimage and reports the result through mountFinished(...).
+     * The process must be cleaned up using unmountAppImage(...)
      */
-    bool mountAppImage(int mountTimeoutMs = 15000);
     void mountAppImageAsync();
     void extractAppImage();
     /**
@@ -104,14 +113,16 @@ public:
      */
     static const QString integratedDesktopPath(const QString& path);
     /**
-     * @brief Get the metadata for the appimage.
-     * @param integration If true gets the metadata from the appimage's
-     * internal desktop
-     * @return The appimages metadata parsed from the desktop file.
+     * @brief Get the metadata for the appimage without blocking the calling thread.
+     * The file work runs on the thread pool and the mount is driven by signals,
+     * so the util must live on a thread with an event loop until the future finishes.
+     * @param action Register reads the appimage's internal desktop file even if integrated
+     * @param mountTimeoutMs Time to wait for the mount before giving up
+     * @return Future with the appimages metadata parsed from the desktop file.
      * If integrated it will use the integrated desktop file,
      * if not it will use the appimage's internal one.
      */
-    AppImageUtilMetadata metadata(MetadataAction action = Default);
+    QFuture<AppImageUtilMetadata> metadataAsync(MetadataAction action = Default, int mountTimeoutMs = 15000);
     /**
      * @brief Gets the mounted appimages desktop path
      * @return Destkop path of the mounted appimage
@@ -123,11 +134,12 @@ public:
      */
     QString getMountedIconPath();
     /**
-     * @brief Registers the app image at the utils path
-     * @return New path of registered app image
-     *
+     * @brief Registers the app image at the utils path. The mount is driven like
+     * metadataAsync(...), the copy and desktop file are then written on the thread pool,
+     * so the util must outlive the future
+     * @return Future with the new path of registered app image, empty on failure
      */
-    QString registerAppImage();
+    QFuture<QString> registerAppImageAsync();
     /**
      * @brief Unregisters the app image at the utils path
      * @return Bool indicating if unregister is successful
@@ -139,10 +151,24 @@ public:
      */
     bool unregisterAppImage(bool deleteAppImage);
     /**
-     * @brief Get ths list of registered appimages
-     * @return List of registered appimages
+     * @brief Loads the registered appimages in parallel on the global thread pool.
+     * The directory scan and desktop index run on the calling thread, every appimage
+     * is then parsed and fingerprinted by its own task. Results arrive in completion order.
+     * @param process Optional method run on the worker for each result, ie to decode the icon
+     * @return Future reporting a result per registered appimage
+     */
+    static QFuture<AppImageUtilMetadata> getRegisteredListAsync(std::function<void(AppImageUtilMetadata&)> process = nullptr);
+    /**
+     * @brief Gets the metadata of a single registered appimage, using the metadata cache
+     * @param path Path to the appimage
+     * @return Metadata, with an empty path if the appimage is missing or not integrated
      */
-    static const QList<AppImageUtilMetadata> getRegisteredList();
+    static const AppImageUtilMetadata getRegisteredMetadata(const QString& path);
+    /**
+     * @brief Gets the folders searched for integrated desktop files
+     * @return List of folders
+     */
+    static const QStringList getSearchPaths();
     /**
      * @brief Save the updater settings to the provided desktop file
      * @param desktopFilePath path to the desktop file
@@ -152,13 +178,16 @@ public:
      */
     static const bool saveUpdaterSettings(const QString& desktopFilePath, const QString& updaterType, const UpdaterSettings& settings);
     /**
-     * @brief Refreshes the integrated desktopfile with the latest values from the appimage's internal desktopfile
+     * @brief Refreshes the integrated desktopfile with the latest values from the appimage's internal desktopfile.
+     * The mount is driven by signals, so it must be called from a thread with an event loop, ie the UI thread.
      * @param appImagePath path to the appiamge
      * @param updateVersion update version override to set in the destkopfile
      * @param updateDate update date override to set in the destkopfile
-     * @return Bool indicating if refresh successful
+     * @param mountTimeoutMs Time to wait for the mount before giving up
+     * @return Future with a bool indicating if refresh successful
      */
-    static const bool refreshDesktopFile(const QString& appImagePath, const QString& updateVersion = QString(), const QString& updateDate = QString());
+    static QFuture<bool> refreshDesktopFileAsync(const QString& appImagePath, const QString& updateVersion = QString(),
+                                                 const QString& updateDate = QString(), int mountTimeoutMs = 15000);
     /**
      * @brief Updates the appimage at appImagePath with the new downloaded appimage.
      * @param appImagePath Path of the appimage to update
@@ -177,21 +206,38 @@ private:
     QString m_mountPath;
     QString m_tempExtractDir;
     QProcess* m_process;
+    QFileSystemWatcher* m_mountWatcher = nullptr;
+    QStringList m_extractPatterns;
+    bool m_selectiveExtract = false;
+    bool m_iconPatternsQueued = false;
     static const QRegularExpression execLineRegex;
     static const QRegularExpression invalidChars;
     static const QString balIntegrationField;
+    static const QStringList iconSearchDirs;
+    static const QStringList iconExtensions;
 
+    static const qint64 getPayloadOffset(QIODevice& device);
+    static const bool readBaseMetadata(const QString& path, MetadataAction action, AppImageUtilMetadata& metadata);
+    void readMountedMetadata(MetadataAction action, AppImageUtilMetadata& metadata);
+    static void readFallbackVersion(AppImageUtilMetadata& metadata);
+    static const AppImageUtilMetadata loadRegisteredMetadata(const QString& path, const QString& desktopPath);
     static const QString escapeDesktopValue(const QString &value);
     static void parseDesktopPathForMetadata(const QString& path, AppImageUtilMetadata& metadata, bool storeDesktopContent = false);
     static const QList<UpdaterFilter> parseFilters(const QString &filterStr);
     QString findNextAvailableFilename(const QString& fullPath);
     QString handleIntegrationFileOperation(QString newName);
-    static const QStringList getSearchPaths();
     static const QString getLocalIntegrationPath();
     static const bool removeFileOrWarn(const QString& path, const QString& label);
     static void updateDesktopKey(QString& targetContents, const QString& sourceContents, const QString& key, const QString& fallback = QString());
     static const QString parseExecLine(const QString& line, const QString& appImagePath);
+    static const bool refreshDesktopFile(AppImageUtil& util, const QString& updateVersion, const QString& updateDate);
+    QString registerAppImage(const AppImageUtilMetadata& utilMetadata);
+    bool extractFromSquashfs();
+    void startExtract(const QString& pattern);
+    const QStringList iconExtractPatterns(const QString& rootPath) const;
     void onMountStdoutReady();
+    bool isMountReady(const QString& path) const;
+    void onMountReady(const QString& path);
     void onMountFinished(int exitCode, QProcess::ExitStatus status);
     void onExtractFinished(int exitCode, QProcess::ExitStatus status);
 
@@ -0,0 +1,188 @@
+#include "appimagewatcherutil.h"
+#include "managers/settingsmanager.h"
+#include "utils/appimageutil.h"
+#include "utils/desktopindexutil.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFuture>
+#include <QtConcurrent/QtConcurrentRun>
+
+// ----------------- Public -----------------
+
+AppImageWatcherUtil::AppImageWatcherUtil(QObject* parent)
+    : QObject(parent)
+{
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(debounceInterval);
+
+    connect(&m_debounce, &QTimer::timeout, this, [this]() { scan(false); });
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &AppImageWatcherUtil::onDirectoryChanged);
+    connect(SettingsManager::instance(), &SettingsManager::appImageDefaultLocationChanged, this, &AppImageWatcherUtil::onLocationChanged);
+}
+
+void AppImageWatcherUtil::start()
+{
+    if (m_started)
+        return;
+
+    m_started = true;
+    updateWatchedPaths();
+    scan(true);
+}
+
+void AppImageWatcherUtil::setIconPath(const QString& appImagePath, const QString& iconPath)
+{
+    // Keyed by icon, an icon shared by several appimages reports only the last one
+    for (auto it = m_iconOwners.begin(); it != m_iconOwners.end();) {
+        if (it.value() == appImagePath)
+            it = m_iconOwners.erase(it);
+        else
+            ++it;
+    }
+
+    if (!iconPath.isEmpty())
+        m_iconOwners.insert(QFileInfo(iconPath).absoluteFilePath(), appImagePath);
+}
+
+// ----------------- Private -----------------
+
+const int AppImageWatcherUtil::debounceInterval = 100;
+
+void AppImageWatcherUtil::onDirectoryChanged(const QString& path)
+{
+    if (AppImageUtil::getSearchPaths().contains(path))
+        m_desktopDirsChanged = true;
+
+    // A folder that was just created, ie the icon folder, needs to be watched too
+    updateWatchedPaths();
+    m_debounce.start();
+}
+
+void AppImageWatcherUtil::onLocationChanged()
+{
+    // Every appimage moves, rebuild the baseline instead of reporting them
+    m_debounce.stop();
+    m_iconOwners.clear();
+    updateWatchedPaths();
+    scan(true);
+}
+
+void AppImageWatcherUtil::scan(bool baseline)
+{
+    if (m_scanning) {
+        m_rescan = true;
+        return;
+    }
+
+    m_scanning = true;
+    const bool invalidate = m_desktopDirsChanged;
+    m_desktopDirsChanged = false;
+
+    QtConcurrent::run([invalidate]() {
+        return takeSnapshot(invalidate);
+    }).then(this, [this, baseline](const Snapshot& snapshot) {
+        m_scanning = false;
+        onScanFinished(snapshot, baseline);
+
+        if (m_rescan) {
+            m_rescan = false;
+            m_debounce.start();
+        }
+    });
+}
+
+void AppImageWatcherUtil::onScanFinished(const Snapshot& snapshot, bool baseline)
+{
+    const Snapshot previous = m_snapshot;
+    m_snapshot = snapshot;
+
+    if (baseline)
+        return;
+
+    QSet<QString> changed;
+    QStringList removed;
+
+    for (auto it = snapshot.appImages.cbegin(); it != snapshot.appImages.cend(); ++it) {
+        auto old = previous.appImages.constFind(it.key());
+        if (old == previous.appImages.cend() || !(old.value() == it.value()))
+            changed.insert(it.key());
+    }
+
+    for (auto it = previous.appImages.cbegin(); it != previous.appImages.cend(); ++it) {
+        if (!snapshot.appImages.contains(it.key()))
+            removed.append(it.key());
+    }
+
+    for (auto it = snapshot.icons.cbegin(); it != snapshot.icons.cend(); ++it) {
+        if (previous.icons.value(it.key()) == it.value())
+            continue;
+
+        const QString owner = m_iconOwners.value(it.key());
+        if (!owner.isEmpty() && snapshot.appImages.contains(owner))
+            changed.insert(owner);
+    }
+
+    if (changed.isEmpty() && removed.isEmpty())
+        return;
+
+    emit appImagesChanged(changed.values(), removed);
+}
+
+void AppImageWatcherUtil::updateWatchedPaths()
+{
+    QStringList paths = AppImageUtil::getSearchPaths();
+    paths << appImageDir() << iconDir();
+
+    QStringList stale = m_watcher.directories();
+    for (const auto& path : paths) {
+        stale.removeAll(path);
+        if (QFileInfo(path).isDir() && !m_watcher.directories().contains(path))
+            m_watcher.addPath(path);
+    }
+
+    if (!stale.isEmpty())
+        m_watcher.removePaths(stale);
+}
+
+const QString AppImageWatcherUtil::appImageDir()
+{
+    return QDir(SettingsManager::instance()->appImageDefaultLocation().toLocalFile()).absolutePath();
+}
+
+const QString AppImageWatcherUtil::iconDir()
+{
+    return QDir(appImageDir()).filePath(".icons");
+}
+
+const AppImageWatcherUtil::Snapshot AppImageWatcherUtil::takeSnapshot(bool invalidateDesktopIndex)
+{
+    Snapshot snapshot;
+
+    // Desktop files edited in place do not change their folder's mtime
+    if (invalidateDesktopIndex)
+        DesktopIndexUtil::invalidate();
+
+    const QHash<QString, QString> desktopIndex = DesktopIndexUtil::index(AppImageUtil::getSearchPaths());
+
+    QDir dir(appImageDir());
+    const QFileInfoList files = dir.entryInfoList(
+        QStringList() << "*.AppImage" << "*.appimage",
+        QDir::Files | QDir::NoSymLinks
+        );
+
+    for (const QFileInfo& fileInfo : files) {
+        const QString path = fileInfo.absoluteFilePath();
+        const QString desktopPath = desktopIndex.value(path);
+
+        // Only integrated appimages are listed
+        if (!desktopPath.isEmpty())
+            snapshot.appImages.insert(path, MetadataCacheUtil::stamp(path, desktopPath));
+    }
+
+    const QFileInfoList icons = QDir(iconDir()).entryInfoList(QDir::Files);
+    for (const QFileInfo& fileInfo : icons)
+        snapshot.icons.insert(fileInfo.absoluteFilePath(), fileInfo.lastModified());
+
+    return snapshot;
+}
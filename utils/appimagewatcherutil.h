@@ -0,0 +1,75 @@
+#ifndef APPIMAGEWATCHERUTIL_H
+#define APPIMAGEWATCHERUTIL_H
+
+#include "utils/metadatacacheutil.h"
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+class AppImageWatcherUtil : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Watches the appimage folder, its icon folder and the desktop search paths,
+     * and reports which appimages changed. Bursts of events are coalesced and only
+     * the watched folders are rescanned, on the global thread pool.
+     * @param parent Parent object
+     */
+    explicit AppImageWatcherUtil(QObject* parent = nullptr);
+
+    /**
+     * @brief Takes the initial snapshot and starts watching
+     */
+    void start();
+    /**
+     * @brief Records the icon file used by an appimage, so changes to it are reported
+     * @param appImagePath Path to the appimage
+     * @param iconPath Path to the icon file, empty to forget it
+     */
+    void setIconPath(const QString& appImagePath, const QString& iconPath);
+
+signals:
+    /**
+     * @brief Emitted after a rescan found differences
+     * @param changed Appimages that were added or whose file, desktop file or icon changed
+     * @param removed Appimages that no longer exist or are no longer integrated
+     */
+    void appImagesChanged(const QStringList& changed, const QStringList& removed);
+
+private:
+    struct Snapshot {
+        QHash<QString, MetadataCacheStamp> appImages;
+        QHash<QString, QDateTime> icons;
+    };
+
+    static const int debounceInterval;
+
+    QFileSystemWatcher m_watcher;
+    QTimer m_debounce;
+    Snapshot m_snapshot;
+    QHash<QString, QString> m_iconOwners;
+    bool m_started = false;
+    bool m_scanning = false;
+    bool m_rescan = false;
+    bool m_desktopDirsChanged = false;
+
+    void onDirectoryChanged(const QString& path);
+    void onLocationChanged();
+    void scan(bool baseline);
+    void onScanFinished(const Snapshot& snapshot, bool baseline);
+    void updateWatchedPaths();
+
+    static const QString appImageDir();
+    static const QString iconDir();
+    static const Snapshot takeSnapshot(bool invalidateDesktopIndex);
+};
+
+#endif // APPIMAGEWATCHERUTIL_H
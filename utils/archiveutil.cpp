@@ -5,40 +5,82 @@
 #include <QFile>
 #include <QString>
 
+#include <cerrno>
+
+namespace {
+
+struct StreamReader {
+    std::function<qint64(char*, qint64)> read;
+    QByteArray buffer;
+};
+
+la_ssize_t streamRead(struct archive *a, void *clientData, const void **buffer)
+{
+    auto *reader = static_cast<StreamReader*>(clientData);
+    const qint64 size = reader->read(reader->buffer.data(), reader->buffer.size());
+    if (size < 0) {
+        archive_set_error(a, EIO, "Stream read failed");
+        return ARCHIVE_FATAL;
+    }
+
+    *buffer = reader->buffer.constData();
+    return size;
+}
+
+}
+
 ArchiveUtil::ArchiveUtil() {}
 
 const bool ArchiveUtil::isZip(const QByteArray &data)
+{
+    // Local file header signature, only the first bytes of the payload are needed
+    return data.startsWith(QByteArrayView("PK\x03\x04", 4));
+}
+
+const bool ArchiveUtil::extractAppImageFromZipFile(const QString &zipFilePath, const QString &outputFilePath)
 {
     struct archive *a = archive_read_new();
     archive_read_support_format_zip(a);
     archive_read_support_filter_all(a);
 
-    int r = archive_read_open_memory(a, data.constData(), data.size());
+    int r = archive_read_open_filename(a, QFile::encodeName(zipFilePath).constData(), 64 * 1024);
     if (r != ARCHIVE_OK) {
         archive_read_free(a);
         return false;
     }
 
-    struct archive_entry *entry;
-    r = archive_read_next_header(a, &entry);
-    archive_read_free(a);
-    return (r == ARCHIVE_OK);
+    return extractAppImage(a, outputFilePath);
 }
 
-const bool ArchiveUtil::extractAppImageFromZip(const QByteArray &zipData, const QString &outputFilePath)
+const bool ArchiveUtil::extractAppImageFromZipStream(std::function<qint64(char*, qint64)> readCallback, const QString &outputFilePath)
 {
+    StreamReader reader;
+    reader.read = readCallback;
+    reader.buffer.resize(streamBufferSize);
+
     struct archive *a = archive_read_new();
     archive_read_support_format_zip(a);
     archive_read_support_filter_all(a);
 
-    int r = archive_read_open_memory(a, zipData.constData(), zipData.size());
+    // No seek callback, so libarchive reads the zip as a stream of local headers
+    int r = archive_read_open(a, &reader, nullptr, streamRead, nullptr);
     if (r != ARCHIVE_OK) {
         archive_read_free(a);
         return false;
     }
 
+    return extractAppImage(a, outputFilePath);
+}
+
+// ----------------- Private -----------------
+
+const qint64 ArchiveUtil::streamBufferSize = 64 * 1024;
+
+const bool ArchiveUtil::extractAppImage(struct archive *a, const QString &outputFilePath)
+{
     struct archive_entry *entry;
     bool found = false;
+    int r;
 
     while (archive_read_next_header(a, &entry) == ARCHIVE_OK) {
         const char *name = archive_entry_pathname(entry);
@@ -56,7 +98,10 @@ const bool ArchiveUtil::extractAppImageFromZip(const QByteArray &zipData, const
             la_int64_t offset;
 
             while ((r = archive_read_data_block(a, &buff, &size, &offset)) == ARCHIVE_OK) {
-                outFile.write(reinterpret_cast<const char*>(buff), size);
+                if (outFile.write(reinterpret_cast<const char*>(buff), size) != static_cast<qint64>(size)) {
+                    r = ARCHIVE_FATAL;
+                    break;
+                }
             }
 
             outFile.close();
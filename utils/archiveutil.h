@@ -2,6 +2,9 @@
 #define ARCHIVEUTIL_H
 
 #include <QByteArray>
+#include <QString>
+
+#include <functional>
 
 class ArchiveUtil
 {
@@ -9,7 +12,20 @@ public:
     ArchiveUtil();
 
     static const bool isZip(const QByteArray &data);
-    static const bool extractAppImageFromZip(const QByteArray &zipData, const QString &outputFilePath);
+    static const bool extractAppImageFromZipFile(const QString &zipFilePath, const QString &outputFilePath);
+    /**
+     * @brief Extracts the appimage from a zip read sequentially through readCallback,
+     * ie a file that is still being downloaded. Never seeks, so only the local headers are used.
+     * @param readCallback Fills the buffer and returns the bytes read, 0 at the end, -1 on error
+     * @param outputFilePath Path of the appimage to write
+     * @return Bool indicating if an appimage was extracted
+     */
+    static const bool extractAppImageFromZipStream(std::function<qint64(char*, qint64)> readCallback, const QString &outputFilePath);
+
+private:
+    static const qint64 streamBufferSize;
+
+    static const bool extractAppImage(struct archive *a, const QString &outputFilePath);
 };
 
 #endif // ARCHIVEUTIL_H
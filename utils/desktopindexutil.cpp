@@ -0,0 +1,101 @@
+#include "desktopindexutil.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QTextStream>
+
+// ----------------- Public -----------------
+
+DesktopIndexUtil::DesktopIndexUtil() {}
+
+const QHash<QString, QString> DesktopIndexUtil::index(const QStringList& searchPaths)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const QList<QDateTime> modified = dirsModified(searchPaths);
+    if (!m_valid || m_searchPaths != searchPaths || m_dirsModified != modified) {
+        rebuild(searchPaths);
+        m_searchPaths = searchPaths;
+        m_dirsModified = modified;
+        m_valid = true;
+    }
+
+    return m_index;
+}
+
+const QString DesktopIndexUtil::lookup(const QString& execPath, const QStringList& searchPaths)
+{
+    QString desktopPath = index(searchPaths).value(execPath);
+
+    // The file may have been removed within the mtime resolution of the directory
+    if (!desktopPath.isEmpty() && !QFile::exists(desktopPath)) {
+        invalidate();
+        desktopPath = index(searchPaths).value(execPath);
+    }
+
+    return desktopPath;
+}
+
+void DesktopIndexUtil::invalidate()
+{
+    QMutexLocker locker(&m_mutex);
+    m_valid = false;
+}
+
+// ----------------- Private -----------------
+
+QMutex DesktopIndexUtil::m_mutex;
+QHash<QString, QString> DesktopIndexUtil::m_index;
+QStringList DesktopIndexUtil::m_searchPaths;
+QList<QDateTime> DesktopIndexUtil::m_dirsModified;
+bool DesktopIndexUtil::m_valid = false;
+
+const QList<QDateTime> DesktopIndexUtil::dirsModified(const QStringList& searchPaths)
+{
+    QList<QDateTime> modified;
+    modified.reserve(searchPaths.size());
+
+    for (const QString& dirPath : searchPaths) {
+        modified.append(QFileInfo(dirPath).lastModified());
+    }
+
+    return modified;
+}
+
+void DesktopIndexUtil::rebuild(const QStringList& searchPaths)
+{
+    m_index.clear();
+
+    for (const QString& dirPath : searchPaths) {
+        QDir dir(dirPath);
+        const QStringList desktopFiles = dir.entryList(QStringList() << "*.desktop", QDir::Files);
+
+        for (const QString& fileName : desktopFiles) {
+            QString filePath = dir.absoluteFilePath(fileName);
+            QFile file(filePath);
+
+            if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+                continue;
+
+            QTextStream in(&file);
+            while (!in.atEnd()) {
+                QString line = in.readLine().trimmed();
+
+                if (line.startsWith("Exec=")) {
+                    QString execLine = line.mid(QString("Exec=").length());
+                    const QStringList execCommandParts = QProcess::splitCommand(execLine);
+
+                    // First desktop file in search order wins
+                    for (const QString& execCommand : execCommandParts) {
+                        if (!m_index.contains(execCommand))
+                            m_index.insert(execCommand, filePath);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef DESKTOPINDEXUTIL_H
+#define DESKTOPINDEXUTIL_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+class DesktopIndexUtil
+{
+public:
+    DesktopIndexUtil();
+
+    /**
+     * @brief Gets the reverse index of exec target -> desktop file path.
+     * The index is rebuilt in a single pass if any of the search paths
+     * changed (by directory mtime) since it was last built.
+     * @param searchPaths Directories containing the desktop files
+     * @return Exec target path -> desktop file path
+     */
+    static const QHash<QString, QString> index(const QStringList& searchPaths);
+    /**
+     * @brief Looks up the desktop file whose Exec line targets the given path
+     * @param execPath Path of the executable, ie the appimage
+     * @param searchPaths Directories containing the desktop files
+     * @return Desktop file path, or empty if none found
+     */
+    static const QString lookup(const QString& execPath, const QStringList& searchPaths);
+    /**
+     * @brief Forces the index to be rebuilt on the next lookup.
+     * Should be called after writing a desktop file in place, as that
+     * does not change the directory mtime.
+     */
+    static void invalidate();
+
+private:
+    static QMutex m_mutex;
+    static QHash<QString, QString> m_index;
+    static QStringList m_searchPaths;
+    static QList<QDateTime> m_dirsModified;
+    static bool m_valid;
+
+    static const QList<QDateTime> dirsModified(const QStringList& searchPaths);
+    static void rebuild(const QStringList& searchPaths);
+};
+
+#endif // DESKTOPINDEXUTIL_H
@@ -0,0 +1,248 @@
+#include "downloadutil.h"
+#include "managers/errormanager.h"
+#include "utils/networkutil.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QNetworkRequest>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QTimer>
+
+// ----------------- Public -----------------
+
+void DownloadUtil::download(const QUrl& url, const QString& filePath,
+                            std::function<void(bool)> finishedCallback,
+                            std::function<void(qint64, qint64)> progressCallback)
+{
+    auto* download = new DownloadUtil(url, filePath, finishedCallback, progressCallback);
+    download->start();
+}
+
+// ----------------- Private -----------------
+
+// Caps how much of the reply Qt buffers in memory before pausing the socket
+const qint64 DownloadUtil::readBufferSize = 1024 * 1024;
+const int DownloadUtil::maxRetries = 5;
+const int DownloadUtil::retryBaseDelayMs = 1000;
+
+DownloadUtil::DownloadUtil(const QUrl& url, const QString& filePath,
+                           std::function<void(bool)> finishedCallback,
+                           std::function<void(qint64, qint64)> progressCallback,
+                           QObject* parent)
+    : QObject(parent)
+    , m_url(url)
+    , m_file(filePath)
+    , m_finishedCallback(finishedCallback)
+    , m_progressCallback(progressCallback)
+{}
+
+void DownloadUtil::start()
+{
+    m_accepted = false;
+    m_restart = false;
+
+    // Only resume a part file if we know what it was fetched under
+    const QString validator = readValidator();
+    const bool resume = !validator.isEmpty() && QFileInfo(m_file.fileName()).size() > 0;
+
+    const QIODevice::OpenMode mode = QIODevice::WriteOnly | (resume ? QIODevice::Append : QIODevice::Truncate);
+    if (!m_file.open(mode)) {
+        ErrorManager::instance()->reportError("Failed to open file for download: " + m_file.fileName());
+        finish(false);
+        return;
+    }
+    m_offset = resume ? m_file.size() : 0;
+
+    QNetworkRequest request(m_url);
+    request.setTransferTimeout(30000);
+    if (m_offset > 0) {
+        request.setRawHeader("Range", "bytes=" + QByteArray::number(m_offset) + "-");
+        request.setRawHeader("If-Range", validator.toUtf8());
+    }
+
+    m_reply = NetworkUtil::networkManager()->get(request);
+    m_reply->setReadBufferSize(readBufferSize);
+
+    connect(m_reply, &QNetworkReply::metaDataChanged, this, &DownloadUtil::onMetaDataChanged);
+    connect(m_reply, &QNetworkReply::readyRead, this, &DownloadUtil::onReadyRead);
+    connect(m_reply, &QNetworkReply::finished, this, &DownloadUtil::onFinished);
+
+    if (m_progressCallback) {
+        connect(m_reply, &QNetworkReply::downloadProgress, this, [this](qint64 received, qint64 total) {
+            m_progressCallback(m_offset + received, total > 0 ? m_offset + total : total);
+        });
+    }
+}
+
+void DownloadUtil::onMetaDataChanged()
+{
+    if (!m_reply)
+        return;
+
+    const int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+    if (status == 206) {
+        // Only continue if the server resumes exactly where the part file ends
+        static const QRegularExpression contentRangeRe(R"(^bytes\s+(\d+)-)");
+        QRegularExpressionMatch match = contentRangeRe.match(QString::fromLatin1(m_reply->rawHeader("Content-Range")));
+        if (!match.hasMatch() || match.captured(1).toLongLong() != m_offset) {
+            m_restart = true;
+            m_reply->abort();
+            return;
+        }
+    } else if (status >= 200 && status < 300) {
+        // Full body, either a fresh download or the validator no longer matched
+        if (m_offset > 0) {
+            m_file.resize(0);
+            m_offset = 0;
+        }
+    } else if (status == 416) {
+        // The part file does not fit the remote file anymore
+        m_restart = true;
+        m_reply->abort();
+        return;
+    } else {
+        // Error body, never written to the part file
+        m_accepted = false;
+        return;
+    }
+
+    m_accepted = true;
+
+    // Remember what the file is being fetched under so a later attempt can resume it.
+    // Weak ETags can't be used with If-Range.
+    const QByteArray etag = m_reply->rawHeader("ETag");
+    const QByteArray lastModified = m_reply->rawHeader("Last-Modified");
+    writeValidator(QString::fromLatin1(!etag.isEmpty() && !etag.startsWith("W/") ? etag : lastModified));
+}
+
+void DownloadUtil::onReadyRead()
+{
+    if (!m_reply)
+        return;
+
+    const QByteArray chunk = m_reply->readAll();
+    if (!m_accepted || !m_file.isOpen())
+        return;
+
+    if (m_file.write(chunk) != chunk.size()) {
+        ErrorManager::instance()->reportError("Failed to write download: " + m_file.errorString());
+        m_file.close();
+        m_reply->abort();
+    }
+}
+
+void DownloadUtil::onFinished()
+{
+    // Flush anything still buffered in the reply
+    onReadyRead();
+
+    const QNetworkReply::NetworkError error = m_reply->error();
+    const int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QString errorString = m_reply->errorString();
+    const bool writable = m_file.isOpen();
+
+    m_file.close();
+    m_reply->deleteLater();
+    m_reply = nullptr;
+
+    if (m_restart && m_attempt < maxRetries) {
+        ++m_attempt;
+        m_file.remove();
+        QFile::remove(metaFilePath());
+        start();
+        return;
+    }
+
+    if (error == QNetworkReply::NoError && m_accepted && writable) {
+        finish(true);
+        return;
+    }
+
+    if (writable && isTransientError(error, status) && m_attempt < maxRetries) {
+        const int delay = retryBaseDelayMs << m_attempt;
+        ++m_attempt;
+        qWarning() << "Download interrupted, retrying in" << delay << "ms:" << errorString;
+        QTimer::singleShot(delay, this, &DownloadUtil::start);
+        return;
+    }
+
+    if (error != QNetworkReply::OperationCanceledError) {
+        ErrorManager::instance()->reportError("Download failed: " + errorString);
+    }
+
+    finish(false);
+}
+
+void DownloadUtil::finish(bool success)
+{
+    if (m_file.isOpen())
+        m_file.close();
+
+    if (m_reply) {
+        m_reply->deleteLater();
+        m_reply = nullptr;
+    }
+
+    // Keep a resumable part file around for the next attempt
+    if (success || readValidator().isEmpty()) {
+        if (!success)
+            m_file.remove();
+        QFile::remove(metaFilePath());
+    }
+
+    if (m_finishedCallback)
+        m_finishedCallback(success);
+
+    deleteLater();
+}
+
+const QString DownloadUtil::metaFilePath() const
+{
+    return m_file.fileName() + ".meta";
+}
+
+const QString DownloadUtil::readValidator() const
+{
+    if (!QFile::exists(metaFilePath()))
+        return QString();
+
+    QSettings meta(metaFilePath(), QSettings::IniFormat);
+    if (meta.value("url").toUrl() != m_url)
+        return QString();
+
+    return meta.value("validator").toString();
+}
+
+void DownloadUtil::writeValidator(const QString& validator) const
+{
+    if (validator.isEmpty()) {
+        QFile::remove(metaFilePath());
+        return;
+    }
+
+    QSettings meta(metaFilePath(), QSettings::IniFormat);
+    meta.setValue("url", m_url);
+    meta.setValue("validator", validator);
+    meta.sync();
+}
+
+const bool DownloadUtil::isTransientError(QNetworkReply::NetworkError error, int status)
+{
+    switch (error) {
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::UnknownNetworkError:
+    case QNetworkReply::InternalServerError:
+    case QNetworkReply::ServiceUnavailableError:
+        return true;
+    default:
+        break;
+    }
+
+    return status == 429 || (status >= 500 && status < 600);
+}
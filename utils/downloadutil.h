@@ -0,0 +1,64 @@
+#ifndef DOWNLOADUTIL_H
+#define DOWNLOADUTIL_H
+
+#include <QFile>
+#include <QNetworkReply>
+#include <QObject>
+#include <QString>
+#include <QUrl>
+
+#include <functional>
+
+class DownloadUtil : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Downloads the url to filePath, streaming the reply to disk in chunks
+     * as it arrives so memory use stays bounded regardless of the file size.
+     * A partial file left by a failed download is resumed with a Range request
+     * as long as the server still reports the validator (ETag/Last-Modified) it
+     * was fetched under. Transient errors are retried with exponential backoff.
+     * Must be called from the thread owning NetworkUtil::networkManager().
+     * @param url Url to download
+     * @param filePath Path of the file to write
+     * @param finishedCallback Method to get called on download complete
+     * @param progressCallback Method to get called with the received/total bytes
+     */
+    static void download(const QUrl& url, const QString& filePath,
+                         std::function<void(bool)> finishedCallback = nullptr,
+                         std::function<void(qint64, qint64)> progressCallback = nullptr);
+
+private:
+    explicit DownloadUtil(const QUrl& url, const QString& filePath,
+                          std::function<void(bool)> finishedCallback,
+                          std::function<void(qint64, qint64)> progressCallback,
+                          QObject* parent = nullptr);
+
+    static const qint64 readBufferSize;
+    static const int maxRetries;
+    static const int retryBaseDelayMs;
+
+    const QUrl m_url;
+    QFile m_file;
+    QNetworkReply* m_reply = nullptr;
+    std::function<void(bool)> m_finishedCallback;
+    std::function<void(qint64, qint64)> m_progressCallback;
+    qint64 m_offset = 0;
+    bool m_accepted = false;
+    bool m_restart = false;
+    int m_attempt = 0;
+
+    void start();
+    void onMetaDataChanged();
+    void onReadyRead();
+    void onFinished();
+    void finish(bool success);
+    const QString metaFilePath() const;
+    const QString readValidator() const;
+    void writeValidator(const QString& validator) const;
+    static const bool isTransientError(QNetworkReply::NetworkError error, int status);
+};
+
+#endif // DOWNLOADUTIL_H
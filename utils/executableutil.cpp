@@ -0,0 +1,87 @@
+#include "executableutil.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QStandardPaths>
+
+// ----------------- Public -----------------
+
+ExecutableUtil::ExecutableUtil() {}
+
+const QString ExecutableUtil::findExecutable(const QString& name)
+{
+    if (name.isEmpty())
+        return QString();
+
+    // Paths are not looked up in $PATH
+    if (name.contains('/'))
+        return QStandardPaths::findExecutable(name);
+
+    QMutexLocker locker(&m_mutex);
+
+    const QStringList paths = searchPaths();
+    const QList<QDateTime> modified = dirsModified(paths);
+    if (!m_valid || m_searchPaths != paths || m_dirsModified != modified) {
+        rebuild(paths);
+        m_searchPaths = paths;
+        m_dirsModified = modified;
+        m_valid = true;
+    }
+
+    return m_index.value(name);
+}
+
+void ExecutableUtil::invalidate()
+{
+    QMutexLocker locker(&m_mutex);
+    m_valid = false;
+}
+
+// ----------------- Private -----------------
+
+QMutex ExecutableUtil::m_mutex;
+QHash<QString, QString> ExecutableUtil::m_index;
+QStringList ExecutableUtil::m_searchPaths;
+QList<QDateTime> ExecutableUtil::m_dirsModified;
+bool ExecutableUtil::m_valid = false;
+
+const QStringList ExecutableUtil::searchPaths()
+{
+    QStringList paths;
+    const QStringList entries = qEnvironmentVariable("PATH").split(QDir::listSeparator(), Qt::SkipEmptyParts);
+    for (const QString& entry : entries) {
+        const QString path = QDir::cleanPath(entry);
+        if (!paths.contains(path))
+            paths.append(path);
+    }
+    return paths;
+}
+
+const QList<QDateTime> ExecutableUtil::dirsModified(const QStringList& searchPaths)
+{
+    QList<QDateTime> modified;
+    modified.reserve(searchPaths.size());
+
+    for (const QString& dirPath : searchPaths) {
+        modified.append(QFileInfo(dirPath).lastModified());
+    }
+
+    return modified;
+}
+
+void ExecutableUtil::rebuild(const QStringList& searchPaths)
+{
+    m_index.clear();
+
+    for (const QString& dirPath : searchPaths) {
+        QDir dir(dirPath);
+        const QStringList executables = dir.entryList(QDir::Files | QDir::Executable);
+
+        // First directory in $PATH order wins
+        for (const QString& fileName : executables) {
+            if (!m_index.contains(fileName))
+                m_index.insert(fileName, dir.absoluteFilePath(fileName));
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef EXECUTABLEUTIL_H
+#define EXECUTABLEUTIL_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+class ExecutableUtil
+{
+public:
+    ExecutableUtil();
+
+    /**
+     * @brief Finds an executable in $PATH, like QStandardPaths::findExecutable.
+     * The $PATH directories are listed once into an index, which is rebuilt
+     * only if $PATH or one of its directories (by mtime) changed.
+     * @param name Executable name, or a path which is checked directly
+     * @return Absolute path of the executable, or empty if not found
+     */
+    static const QString findExecutable(const QString& name);
+    /**
+     * @brief Forces the index to be rebuilt on the next lookup
+     */
+    static void invalidate();
+
+private:
+    static QMutex m_mutex;
+    static QHash<QString, QString> m_index;
+    static QStringList m_searchPaths;
+    static QList<QDateTime> m_dirsModified;
+    static bool m_valid;
+
+    static const QStringList searchPaths();
+    static const QList<QDateTime> dirsModified(const QStringList& searchPaths);
+    static void rebuild(const QStringList& searchPaths);
+};
+
+#endif // EXECUTABLEUTIL_H
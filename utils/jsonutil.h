@@ -8,79 +8,137 @@
 #include <QList>
 #include <QString>
 
-class JsonUtil
+/**
+ * @brief Path into a json document, ie "assets[*].browser_download_url", parsed once
+ * into segments so it can be evaluated against many documents without reparsing
+ */
+class JsonPath
 {
 public:
-    static QList<QJsonValue> getValuesByPath(const QJsonValue &root, const QString &path) {
-        QList<QJsonValue> current { root };
-
-        if (path.isEmpty())
-            return { root };
+    JsonPath() = default;
 
-        QStringList segments = path.split('.', Qt::SkipEmptyParts);
-        QRegularExpression indexRe(R"(^(.*)\[(\d+)\]$)");
+    explicit JsonPath(const QString &path) {
+        const QStringList parts = path.split('.', Qt::SkipEmptyParts);
+        m_segments.reserve(parts.size());
 
-        for (QString &seg : segments) {
-            seg = seg.trimmed();
-            QList<QJsonValue> next;
+        for (const QString &part : parts) {
+            const QString seg = part.trimmed();
+            Segment segment;
+            segment.key = seg;
 
-            bool isArrayWildcard = seg.endsWith("[*]");
-            int arrayIndex = -1;
-            QString key = seg;
+            // Numeric index like "assets[0]", or wildcard like "assets[*]"
+            const qsizetype open = seg.lastIndexOf('[');
+            if (seg.endsWith(']') && open >= 0) {
+                const QStringView inner = QStringView(seg).mid(open + 1, seg.length() - open - 2);
+                bool isIndex = !inner.isEmpty();
+                for (QChar c : inner)
+                    isIndex = isIndex && c.isDigit();
 
-            // Check for numeric index like "assets[0]"
-            QRegularExpressionMatch match = indexRe.match(seg);
-            if (match.hasMatch()) {
-                key = match.captured(1);
-                arrayIndex = match.captured(2).toInt();
-            } else if (isArrayWildcard) {
-                key = seg.left(seg.length() - 3);
+                if (inner == u"*") {
+                    segment.key = seg.left(open);
+                    segment.wildcard = true;
+                } else if (isIndex) {
+                    segment.key = seg.left(open);
+                    segment.index = inner.toInt();
+                }
             }
 
-            for (const QJsonValue &val : current) {
-                QJsonValue child;
+            m_segments.append(segment);
+        }
+    }
 
-                // Object access
-                if (val.isObject() && !key.isEmpty()) {
-                    const QJsonObject obj = val.toObject();
-                    child = obj.value(key);
-                }
+    bool isEmpty() const { return m_segments.isEmpty(); }
 
-                // Array access at root or intermediate
-                else if (val.isArray() && key.isEmpty()) {
-                    child = val;
-                }
+    /**
+     * @brief Gets every value the path matches
+     * @param root Document to evaluate the path against
+     * @return Matched values, in document order
+     */
+    QList<QJsonValue> values(const QJsonValue &root) const {
+        QList<QJsonValue> out;
+        visit(root, 0, out, false);
+        return out;
+    }
 
-                // Wildcard [*]
-                if (isArrayWildcard && child.isArray()) {
-                    for (const QJsonValue &arrVal : child.toArray())
-                        next.append(arrVal);
-                }
-                // Numeric index [n]
-                else if (arrayIndex >= 0 && child.isArray()) {
-                    QJsonArray arr = child.toArray();
-                    if (arrayIndex < arr.size())
-                    {
-                        next.append(arr[arrayIndex]);
-                    }
-                    else
-                    {
-                        QString message = QString("Index %1 out of range for key %2").arg(arrayIndex).arg(key);
-                        ErrorManager::instance()->reportError(message);
-                    }
-                }
-                // Normal key access
-                else if (arrayIndex < 0 && !isArrayWildcard) {
-                    if (!child.isUndefined())
-                        next.append(child);
-                }
+    /**
+     * @brief Gets the first value the path matches, stopping the walk there
+     * @param root Document to evaluate the path against
+     * @return First matched value, or undefined if none
+     */
+    QJsonValue first(const QJsonValue &root) const {
+        QList<QJsonValue> out;
+        visit(root, 0, out, true);
+        return out.isEmpty() ? QJsonValue(QJsonValue::Undefined) : out.first();
+    }
+
+private:
+    struct Segment {
+        QString key;
+        int index = -1;
+        bool wildcard = false;
+    };
+
+    QList<Segment> m_segments;
+
+    // Depth first, so no list of intermediate values is built per segment
+    bool visit(const QJsonValue &val, int depth, QList<QJsonValue> &out, bool firstOnly) const {
+        if (depth == m_segments.size()) {
+            out.append(val);
+            return firstOnly;
+        }
+
+        const Segment &seg = m_segments.at(depth);
+        QJsonValue child;
+
+        // Object access
+        if (val.isObject() && !seg.key.isEmpty())
+            child = val[seg.key];
+        // Array access at root or intermediate
+        else if (val.isArray() && seg.key.isEmpty())
+            child = val;
+
+        // Wildcard [*]
+        if (seg.wildcard) {
+            if (!child.isArray())
+                return false;
+
+            const QJsonArray arr = child.toArray();
+            for (const QJsonValue &arrVal : arr) {
+                if (visit(arrVal, depth + 1, out, firstOnly))
+                    return true;
             }
+            return false;
+        }
+
+        // Numeric index [n]
+        if (seg.index >= 0) {
+            if (!child.isArray())
+                return false;
 
-            current = next;
-            if (current.isEmpty()) break;
+            const QJsonArray arr = child.toArray();
+            if (seg.index >= arr.size()) {
+                QString message = QString("Index %1 out of range for key %2").arg(seg.index).arg(seg.key);
+                ErrorManager::instance()->reportError(message);
+                return false;
+            }
+            return visit(arr.at(seg.index), depth + 1, out, firstOnly);
         }
 
-        return current;
+        // Normal key access
+        if (child.isUndefined())
+            return false;
+        return visit(child, depth + 1, out, firstOnly);
+    }
+};
+
+class JsonUtil
+{
+public:
+    static QList<QJsonValue> getValuesByPath(const QJsonValue &root, const QString &path) {
+        if (path.isEmpty())
+            return { root };
+
+        return JsonPath(path).values(root);
     }
 };
 
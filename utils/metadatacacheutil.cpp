@@ -0,0 +1,210 @@
+#include "metadatacacheutil.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QSet>
+
+#include <sys/stat.h>
+
+namespace {
+
+constexpr quint32 cacheMagic = 0x42414c4d; // "BALM"
+constexpr quint32 cacheVersion = 2;
+
+const qint64 toNs(const struct timespec& ts)
+{
+    return static_cast<qint64>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+void writeMetadata(QDataStream& out, const AppImageUtilMetadata& metadata)
+{
+    out << metadata.name << metadata.version << metadata.comment << qint32(metadata.type)
+        << metadata.checksum << metadata.categories << metadata.path << metadata.desktopFilePath
+        << metadata.internalIntegration << metadata.iconPath << metadata.executable
+        << metadata.updateType << metadata.updateUrl << metadata.updateDownloadField
+        << metadata.updateDownloadPattern << metadata.updateDateField << metadata.updateVersionField
+        << metadata.updateVersionPattern << metadata.updateCurrentVersion << metadata.updateCurrentDate;
+
+    out << qint32(metadata.updateFilters.size());
+    for (const auto& filter : metadata.updateFilters) {
+        out << filter.field << filter.pattern;
+    }
+}
+
+void readMetadata(QDataStream& in, AppImageUtilMetadata& metadata)
+{
+    qint32 type = 0;
+    in >> metadata.name >> metadata.version >> metadata.comment >> type
+        >> metadata.checksum >> metadata.categories >> metadata.path >> metadata.desktopFilePath
+        >> metadata.internalIntegration >> metadata.iconPath >> metadata.executable
+        >> metadata.updateType >> metadata.updateUrl >> metadata.updateDownloadField
+        >> metadata.updateDownloadPattern >> metadata.updateDateField >> metadata.updateVersionField
+        >> metadata.updateVersionPattern >> metadata.updateCurrentVersion >> metadata.updateCurrentDate;
+    metadata.type = type;
+
+    qint32 filterCount = 0;
+    in >> filterCount;
+    for (qint32 i = 0; i < filterCount && in.status() == QDataStream::Ok; ++i) {
+        UpdaterFilter filter;
+        in >> filter.field >> filter.pattern;
+        metadata.updateFilters.append(filter);
+    }
+}
+
+}
+
+// ----------------- Public -----------------
+
+MetadataCacheUtil::MetadataCacheUtil() {}
+
+const MetadataCacheStamp MetadataCacheUtil::stamp(const QString& path, const QString& desktopFilePath)
+{
+    MetadataCacheStamp stamp;
+    struct stat st;
+
+    if (::stat(QFile::encodeName(path).constData(), &st) != 0)
+        return stamp;
+
+    stamp.inode = st.st_ino;
+    stamp.size = st.st_size;
+    stamp.modified = toNs(st.st_mtim);
+    stamp.desktopFilePath = desktopFilePath;
+
+    if (!desktopFilePath.isEmpty() && ::stat(QFile::encodeName(desktopFilePath).constData(), &st) == 0)
+        stamp.desktopModified = toNs(st.st_mtim);
+
+    return stamp;
+}
+
+const bool MetadataCacheUtil::lookup(const QString& path, const MetadataCacheStamp& stamp, AppImageUtilMetadata& metadata)
+{
+    if (!stamp.isValid())
+        return false;
+
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    auto it = m_entries.constFind(path);
+    if (it == m_entries.constEnd() || !(it->stamp == stamp))
+        return false;
+
+    metadata = it->metadata;
+    return true;
+}
+
+void MetadataCacheUtil::insert(const QString& path, const MetadataCacheStamp& stamp, const AppImageUtilMetadata& metadata)
+{
+    if (!stamp.isValid())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    Entry entry;
+    entry.stamp = stamp;
+    entry.metadata = metadata;
+    entry.metadata.mountedDesktopContents.clear();
+    m_entries.insert(path, entry);
+    m_dirty = true;
+}
+
+void MetadataCacheUtil::retain(const QStringList& paths)
+{
+    QMutexLocker locker(&m_mutex);
+    load();
+
+    const QSet<QString> keep(paths.cbegin(), paths.cend());
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (!keep.contains(it.key())) {
+            it = m_entries.erase(it);
+            m_dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MetadataCacheUtil::save()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_dirty)
+        return;
+
+    const QString filePath = cacheFilePath();
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write metadata cache:" << filePath;
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_8);
+    out << cacheMagic << cacheVersion << qint32(m_entries.size());
+
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        const MetadataCacheStamp& stamp = it->stamp;
+        out << it.key() << stamp.inode << stamp.size << stamp.modified
+            << stamp.desktopFilePath << stamp.desktopModified;
+        writeMetadata(out, it->metadata);
+    }
+
+    if (file.commit())
+        m_dirty = false;
+}
+
+// ----------------- Private -----------------
+
+QMutex MetadataCacheUtil::m_mutex;
+QHash<QString, MetadataCacheUtil::Entry> MetadataCacheUtil::m_entries;
+bool MetadataCacheUtil::m_loaded = false;
+bool MetadataCacheUtil::m_dirty = false;
+
+const QString MetadataCacheUtil::cacheFilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/metadata.cache";
+}
+
+void MetadataCacheUtil::load()
+{
+    if (m_loaded)
+        return;
+    m_loaded = true;
+
+    QFile file(cacheFilePath());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_8);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    in >> magic >> version >> count;
+    if (magic != cacheMagic || version != cacheVersion)
+        return;
+
+    QHash<QString, Entry> entries;
+    entries.reserve(count);
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString path;
+        Entry entry;
+        MetadataCacheStamp& stamp = entry.stamp;
+        in >> path >> stamp.inode >> stamp.size >> stamp.modified
+            >> stamp.desktopFilePath >> stamp.desktopModified;
+        readMetadata(in, entry.metadata);
+        entries.insert(path, entry);
+    }
+
+    // A truncated/corrupt cache is discarded entirely
+    if (in.status() == QDataStream::Ok)
+        m_entries = entries;
+}
@@ -0,0 +1,72 @@
+#ifndef METADATACACHEUTIL_H
+#define METADATACACHEUTIL_H
+
+#include "utils/appimageutil.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+struct MetadataCacheStamp {
+public:
+    quint64 inode = 0;
+    qint64 size = -1;
+    qint64 modified = -1;
+    QString desktopFilePath = QString();
+    qint64 desktopModified = -1;
+
+    bool isValid() const { return size >= 0; }
+    bool operator==(const MetadataCacheStamp& other) const = default;
+};
+
+class MetadataCacheUtil
+{
+public:
+    MetadataCacheUtil();
+
+    /**
+     * @brief Stats the appimage and its desktop file to build a cache stamp
+     * @param path Path to the appimage
+     * @param desktopFilePath Path to the integrated desktop file
+     * @return Stamp, invalid if the appimage could not be stat'd
+     */
+    static const MetadataCacheStamp stamp(const QString& path, const QString& desktopFilePath);
+    /**
+     * @brief Gets the cached metadata for the appimage if the stamp still matches
+     * @param path Path to the appimage
+     * @param stamp Current stamp of the appimage
+     * @param metadata Filled with the cached metadata on hit
+     * @return Bool indicating if it was a cache hit
+     */
+    static const bool lookup(const QString& path, const MetadataCacheStamp& stamp, AppImageUtilMetadata& metadata);
+    /**
+     * @brief Inserts or replaces the cached metadata for the appimage
+     */
+    static void insert(const QString& path, const MetadataCacheStamp& stamp, const AppImageUtilMetadata& metadata);
+    /**
+     * @brief Removes every cached entry not in paths
+     * @param paths Paths of the appimages to keep
+     */
+    static void retain(const QStringList& paths);
+    /**
+     * @brief Writes the cache to disk if it changed since it was loaded
+     */
+    static void save();
+
+private:
+    struct Entry {
+        MetadataCacheStamp stamp;
+        AppImageUtilMetadata metadata;
+    };
+
+    static QMutex m_mutex;
+    static QHash<QString, Entry> m_entries;
+    static bool m_loaded;
+    static bool m_dirty;
+
+    static const QString cacheFilePath();
+    static void load();
+};
+
+#endif // METADATACACHEUTIL_H
@@ -0,0 +1,41 @@
+#ifndef REGEXUTIL_H
+#define REGEXUTIL_H
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QString>
+
+class RegexUtil
+{
+public:
+    // Get a compiled, JIT optimised regex for a pattern, compiling it only the first time
+    // Safe to call from any thread, the returned regex shares the cached compiled pattern
+    static QRegularExpression get(const QString &pattern,
+                                  QRegularExpression::PatternOptions options = QRegularExpression::NoPatternOption) {
+        static QMutex mutex;
+        static QHash<QString, QRegularExpression> cache;
+
+        const QString key = QString::number(options.toInt()) + QChar(0x1f) + pattern;
+
+        QMutexLocker locker(&mutex);
+        auto it = cache.constFind(key);
+        if (it != cache.cend())
+            return it.value();
+
+        // User patterns are unbounded, start over rather than grow forever
+        if (cache.size() >= maxCachedPatterns)
+            cache.clear();
+
+        QRegularExpression re(pattern, options);
+        re.optimize();
+        cache.insert(key, re);
+        return re;
+    }
+
+private:
+    static constexpr qsizetype maxCachedPatterns = 1024;
+};
+
+#endif // REGEXUTIL_H
@@ -0,0 +1,501 @@
+#include "squashfsutil.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QtEndian>
+
+#include <algorithm>
+
+#include <zlib.h>
+
+#ifdef SQUASHFS_XZ
+#include <lzma.h>
+#endif
+
+#ifdef SQUASHFS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+constexpr quint32 squashfsMagic = 0x73717368; // "hsqs"
+constexpr qint64 superblockSize = 96;
+constexpr qint64 metadataBlockSize = 8192;
+constexpr quint32 noFragment = 0xFFFFFFFF;
+constexpr quint32 blockUncompressed = 0x1000000;
+
+enum Compression : quint16 {
+    Gzip = 1,
+    Xz = 4,
+    Zstd = 6
+};
+
+quint16 le16(const QByteArray& data, qsizetype offset)
+{
+    return qFromLittleEndian<quint16>(data.constData() + offset);
+}
+
+quint32 le32(const QByteArray& data, qsizetype offset)
+{
+    return qFromLittleEndian<quint32>(data.constData() + offset);
+}
+
+quint64 le64(const QByteArray& data, qsizetype offset)
+{
+    return qFromLittleEndian<quint64>(data.constData() + offset);
+}
+
+SquashfsEntry::Type entryType(quint16 type)
+{
+    switch (type) {
+    case 1:
+    case 8:
+        return SquashfsEntry::Directory;
+    case 2:
+    case 9:
+        return SquashfsEntry::File;
+    case 3:
+    case 10:
+        return SquashfsEntry::SymLink;
+    default:
+        return SquashfsEntry::Other;
+    }
+}
+
+}
+
+// ----------------- Public -----------------
+
+SquashfsUtil::SquashfsUtil(const QString& path, qint64 offset)
+    : m_file(path), m_offset(offset) {}
+
+SquashfsUtil::~SquashfsUtil()
+{
+    if (m_map)
+        m_file.unmap(m_map);
+}
+
+const bool SquashfsUtil::open()
+{
+    if (m_data)
+        return true;
+
+    if (!m_file.open(QIODevice::ReadOnly) || m_offset < 0 || m_file.size() < m_offset + superblockSize)
+        return false;
+
+    m_map = m_file.map(0, m_file.size());
+    if (!m_map)
+        return false;
+
+    m_data = m_map + m_offset;
+    m_size = m_file.size() - m_offset;
+
+    const QByteArray superblock(reinterpret_cast<const char*>(m_data), superblockSize);
+    const quint16 blockLog = le16(superblock, 22);
+    m_blockSize = le32(superblock, 12);
+    m_fragmentCount = le32(superblock, 16);
+    m_compression = le16(superblock, 20);
+    m_rootInode = le64(superblock, 32);
+    m_inodeTable = le64(superblock, 64);
+    m_directoryTable = le64(superblock, 72);
+    m_fragmentTable = le64(superblock, 80);
+
+    if (le32(superblock, 0) != squashfsMagic || le16(superblock, 28) != 4
+        || blockLog < 12 || blockLog > 20 || m_blockSize != (1u << blockLog)) {
+        m_data = nullptr;
+        return false;
+    }
+
+    switch (m_compression) {
+    case Gzip:
+#ifdef SQUASHFS_XZ
+    case Xz:
+#endif
+#ifdef SQUASHFS_ZSTD
+    case Zstd:
+#endif
+        return true;
+    default:
+        qWarning() << "Unsupported squashfs compression" << m_compression << "in" << m_file.fileName();
+        m_data = nullptr;
+        return false;
+    }
+}
+
+const QList<SquashfsEntry> SquashfsUtil::entries(const QString& dirPath)
+{
+    QList<SquashfsEntry> result;
+    Inode inode;
+    QList<DirectoryEntry> entries;
+
+    if (!m_data || !lookup(dirPath, true, inode) || inode.type != SquashfsEntry::Directory
+        || !readDirectory(inode, entries)) {
+        return result;
+    }
+
+    result.reserve(entries.size());
+    for (const DirectoryEntry& entry : entries)
+        result.append(entry.entry);
+
+    return result;
+}
+
+const QString SquashfsUtil::canonicalPath(const QString& path)
+{
+    Inode inode;
+    QString resolvedPath;
+    if (!m_data || !lookup(path, true, inode, &resolvedPath))
+        return QString();
+
+    return resolvedPath;
+}
+
+const bool SquashfsUtil::extractFile(const QString& path, const QString& outputFilePath)
+{
+    Inode inode;
+    if (!m_data || !lookup(path, true, inode) || inode.type != SquashfsEntry::File)
+        return false;
+
+    QFile out(outputFilePath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    quint64 position = inode.blocksStart;
+    qint64 remaining = static_cast<qint64>(inode.fileSize);
+    QByteArray block;
+
+    for (quint32 blockSize : inode.blockSizes) {
+        const qint64 length = qMin<qint64>(remaining, m_blockSize);
+        const quint32 storedSize = blockSize & (blockUncompressed - 1);
+
+        if (storedSize == 0) {
+            // Sparse block
+            block = QByteArray(length, '\0');
+        } else {
+            const uchar* source = bytes(position, storedSize);
+            if (!source)
+                return false;
+
+            if (blockSize & blockUncompressed)
+                block = QByteArray::fromRawData(reinterpret_cast<const char*>(source), storedSize);
+            else if (!decompress(source, storedSize, block, m_blockSize))
+                return false;
+
+            position += storedSize;
+        }
+
+        if (block.size() < length || out.write(block.constData(), length) != length)
+            return false;
+        remaining -= length;
+    }
+
+    // The tail of the file is packed into a shared fragment block
+    if (remaining > 0) {
+        QByteArray fragment;
+        if (inode.fragmentIndex == noFragment || !readFragment(inode.fragmentIndex, fragment)
+            || inode.fragmentOffset + remaining > fragment.size()) {
+            return false;
+        }
+
+        if (out.write(fragment.constData() + inode.fragmentOffset, remaining) != remaining)
+            return false;
+    }
+
+    return true;
+}
+
+// ----------------- Private -----------------
+
+const int SquashfsUtil::maxSymLinkDepth = 16;
+
+const uchar* SquashfsUtil::bytes(quint64 offset, quint64 size) const
+{
+    if (!m_data || offset > static_cast<quint64>(m_size) || size > static_cast<quint64>(m_size) - offset)
+        return nullptr;
+
+    return m_data + offset;
+}
+
+bool SquashfsUtil::decompress(const uchar* source, qint64 sourceSize, QByteArray& out, qint64 maxSize) const
+{
+    out.resize(maxSize);
+
+    switch (m_compression) {
+    case Gzip: {
+        uLongf size = static_cast<uLongf>(maxSize);
+        if (uncompress(reinterpret_cast<Bytef*>(out.data()), &size, source, static_cast<uLong>(sourceSize)) != Z_OK)
+            return false;
+        out.resize(static_cast<qsizetype>(size));
+        return true;
+    }
+#ifdef SQUASHFS_XZ
+    case Xz: {
+        uint64_t memoryLimit = UINT64_MAX;
+        size_t inPosition = 0;
+        size_t outPosition = 0;
+        if (lzma_stream_buffer_decode(&memoryLimit, 0, nullptr, source, &inPosition, sourceSize,
+                                      reinterpret_cast<uint8_t*>(out.data()), &outPosition, maxSize) != LZMA_OK) {
+            return false;
+        }
+        out.resize(static_cast<qsizetype>(outPosition));
+        return true;
+    }
+#endif
+#ifdef SQUASHFS_ZSTD
+    case Zstd: {
+        const size_t size = ZSTD_decompress(out.data(), maxSize, source, sourceSize);
+        if (ZSTD_isError(size))
+            return false;
+        out.resize(static_cast<qsizetype>(size));
+        return true;
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+bool SquashfsUtil::readMetadataBlock(quint64 position, const MetadataBlock*& block)
+{
+    auto it = m_metadataCache.constFind(position);
+    if (it != m_metadataCache.constEnd()) {
+        block = &it.value();
+        return true;
+    }
+
+    const uchar* header = bytes(position, 2);
+    if (!header)
+        return false;
+
+    const quint16 value = qFromLittleEndian<quint16>(header);
+    const quint32 size = value & 0x7FFF;
+    const uchar* source = bytes(position + 2, size);
+    if (!source || size == 0)
+        return false;
+
+    MetadataBlock metadataBlock;
+    metadataBlock.next = position + 2 + size;
+
+    if (value & 0x8000)
+        metadataBlock.data = QByteArray(reinterpret_cast<const char*>(source), size);
+    else if (!decompress(source, size, metadataBlock.data, metadataBlockSize))
+        return false;
+
+    block = &m_metadataCache.insert(position, metadataBlock).value();
+    return true;
+}
+
+bool SquashfsUtil::readMetadata(quint64 position, quint32 offset, qint64 size, QByteArray& out)
+{
+    // A metadata entry may continue in the following blocks
+    out.clear();
+    while (out.size() < size) {
+        const MetadataBlock* block = nullptr;
+        if (!readMetadataBlock(position, block) || offset > static_cast<quint32>(block->data.size()))
+            return false;
+
+        const qint64 length = qMin<qint64>(size - out.size(), block->data.size() - offset);
+        out.append(block->data.constData() + offset, length);
+        position = block->next;
+        offset = 0;
+    }
+
+    return true;
+}
+
+bool SquashfsUtil::readInode(quint64 ref, Inode& inode)
+{
+    const quint64 position = m_inodeTable + (ref >> 16);
+    const quint32 offset = ref & 0xFFFF;
+
+    inode = Inode();
+    QByteArray data;
+    if (!readMetadata(position, offset, 16, data))
+        return false;
+
+    const quint16 type = le16(data, 0);
+    inode.type = entryType(type);
+
+    switch (type) {
+    case 1: // Basic directory
+        if (!readMetadata(position, offset, 32, data))
+            return false;
+        inode.dirBlock = le32(data, 16);
+        inode.dirSize = le16(data, 24);
+        inode.dirOffset = le16(data, 26);
+        return true;
+    case 8: // Extended directory
+        if (!readMetadata(position, offset, 40, data))
+            return false;
+        inode.dirSize = le32(data, 20);
+        inode.dirBlock = le32(data, 24);
+        inode.dirOffset = le16(data, 34);
+        return true;
+    case 2:   // Basic file
+    case 9: { // Extended file
+        const bool extended = type == 9;
+        const qint64 headerSize = extended ? 56 : 32;
+        if (!readMetadata(position, offset, headerSize, data))
+            return false;
+
+        inode.blocksStart = extended ? le64(data, 16) : le32(data, 16);
+        inode.fileSize = extended ? le64(data, 24) : le32(data, 28);
+        inode.fragmentIndex = le32(data, extended ? 44 : 20);
+        inode.fragmentOffset = le32(data, extended ? 48 : 24);
+
+        if (inode.fileSize > static_cast<quint64>(m_size) * 64)
+            return false;
+
+        quint64 blockCount = inode.fileSize / m_blockSize;
+        if (inode.fragmentIndex == noFragment && inode.fileSize % m_blockSize != 0)
+            ++blockCount;
+
+        if (!readMetadata(position, offset, headerSize + blockCount * 4, data))
+            return false;
+
+        inode.blockSizes.reserve(blockCount);
+        for (quint64 i = 0; i < blockCount; ++i)
+            inode.blockSizes.append(le32(data, headerSize + i * 4));
+        return true;
+    }
+    case 3:    // Basic symlink
+    case 10: { // Extended symlink
+        if (!readMetadata(position, offset, 24, data))
+            return false;
+
+        const quint32 targetSize = le32(data, 20);
+        if (targetSize > 4096 || !readMetadata(position, offset, 24 + targetSize, data))
+            return false;
+
+        inode.target = data.mid(24, targetSize);
+        return true;
+    }
+    default:
+        return true;
+    }
+}
+
+bool SquashfsUtil::readDirectory(const Inode& dir, QList<DirectoryEntry>& entries)
+{
+    // The stored size counts the implicit "." and ".." entries
+    if (dir.dirSize <= 3)
+        return true;
+
+    QByteArray data;
+    if (!readMetadata(m_directoryTable + dir.dirBlock, dir.dirOffset, dir.dirSize - 3, data))
+        return false;
+
+    qsizetype position = 0;
+    while (position + 12 <= data.size()) {
+        const quint32 count = le32(data, position) + 1;
+        const quint32 start = le32(data, position + 4);
+        position += 12;
+
+        if (count > 256)
+            return false;
+
+        for (quint32 i = 0; i < count; ++i) {
+            if (position + 8 > data.size())
+                return false;
+
+            const quint16 offset = le16(data, position);
+            const quint16 type = le16(data, position + 4);
+            const qsizetype nameSize = le16(data, position + 6) + 1;
+            position += 8;
+
+            if (position + nameSize > data.size())
+                return false;
+
+            DirectoryEntry entry;
+            entry.entry.name = QString::fromUtf8(data.constData() + position, nameSize);
+            entry.entry.type = entryType(type);
+            entry.inode = (static_cast<quint64>(start) << 16) | offset;
+            entries.append(entry);
+
+            position += nameSize;
+        }
+    }
+
+    return true;
+}
+
+bool SquashfsUtil::readFragment(quint32 index, QByteArray& fragment)
+{
+    if (index >= m_fragmentCount)
+        return false;
+
+    auto it = m_fragmentCache.constFind(index);
+    if (it != m_fragmentCache.constEnd()) {
+        fragment = it.value();
+        return true;
+    }
+
+    // The fragment table is indexed by a list of pointers to its metadata blocks
+    const uchar* pointer = bytes(m_fragmentTable + (index / 512) * 8, 8);
+    QByteArray entry;
+    if (!pointer || !readMetadata(qFromLittleEndian<quint64>(pointer), (index % 512) * 16, 16, entry))
+        return false;
+
+    const quint64 start = le64(entry, 0);
+    const quint32 size = le32(entry, 8);
+    const quint32 storedSize = size & (blockUncompressed - 1);
+    const uchar* source = bytes(start, storedSize);
+    if (!source)
+        return false;
+
+    if (size & blockUncompressed)
+        fragment = QByteArray(reinterpret_cast<const char*>(source), storedSize);
+    else if (!decompress(source, storedSize, fragment, m_blockSize))
+        return false;
+
+    m_fragmentCache.insert(index, fragment);
+    return true;
+}
+
+bool SquashfsUtil::lookup(const QString& path, bool followLast, Inode& inode, QString* resolvedPath, int depth)
+{
+    if (depth > maxSymLinkDepth)
+        return false;
+
+    const QStringList parts = QDir::cleanPath(path).split('/', Qt::SkipEmptyParts);
+    if (!readInode(m_rootInode, inode))
+        return false;
+
+    for (qsizetype i = 0; i < parts.size(); ++i) {
+        const QString& part = parts.at(i);
+        if (part == ".")
+            continue;
+
+        // Paths may not leave the image
+        if (part == ".." || inode.type != SquashfsEntry::Directory)
+            return false;
+
+        QList<DirectoryEntry> entries;
+        if (!readDirectory(inode, entries))
+            return false;
+
+        auto it = std::find_if(entries.cbegin(), entries.cend(), [&part](const DirectoryEntry& entry) {
+            return entry.entry.name == part;
+        });
+        if (it == entries.cend() || !readInode(it->inode, inode))
+            return false;
+
+        const bool last = i == parts.size() - 1;
+        if (inode.type == SquashfsEntry::SymLink && (!last || followLast)) {
+            // Absolute targets point at the host system, not into the image
+            const QString target = QString::fromUtf8(inode.target);
+            if (target.isEmpty() || target.startsWith('/'))
+                return false;
+
+            QStringList resolved = parts.mid(0, i);
+            resolved.append(target);
+            resolved.append(parts.mid(i + 1));
+            return lookup(resolved.join('/'), followLast, inode, resolvedPath, depth + 1);
+        }
+    }
+
+    if (resolvedPath)
+        *resolvedPath = parts.join('/');
+
+    return true;
+}
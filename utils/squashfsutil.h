@@ -0,0 +1,112 @@
+#ifndef SQUASHFSUTIL_H
+#define SQUASHFSUTIL_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+struct SquashfsEntry {
+public:
+    enum Type {
+        Other,
+        Directory,
+        File,
+        SymLink
+    };
+
+    QString name = QString();
+    Type type = Other;
+};
+
+class SquashfsUtil
+{
+public:
+    /**
+     * @brief Read only, in process access to a squashfs 4 image, ie the payload
+     * of an appimage. The file is memory mapped and nothing in it is executed.
+     * @param path Path to the file containing the image
+     * @param offset Offset of the image in the file
+     */
+    SquashfsUtil(const QString& path, qint64 offset = 0);
+    ~SquashfsUtil();
+
+    /**
+     * @brief Maps the file and reads the superblock
+     * @return Bool indicating if the image is valid and its compression supported
+     */
+    const bool open();
+    /**
+     * @brief Lists a directory of the image, following symlinks in the path
+     * @param dirPath Path of the directory relative to the image root
+     * @return Entries of the directory, empty if not found
+     */
+    const QList<SquashfsEntry> entries(const QString& dirPath);
+    /**
+     * @brief Resolves every symlink in path
+     * @param path Path relative to the image root
+     * @return Resolved path relative to the image root, or empty if it leaves the image or does not exist
+     */
+    const QString canonicalPath(const QString& path);
+    /**
+     * @brief Extracts a regular file, following symlinks
+     * @param path Path of the file relative to the image root
+     * @param outputFilePath Path of the file to write
+     * @return Bool indicating if extract successful
+     */
+    const bool extractFile(const QString& path, const QString& outputFilePath);
+
+private:
+    struct Inode {
+        SquashfsEntry::Type type = SquashfsEntry::Other;
+        quint64 fileSize = 0;
+        quint64 blocksStart = 0;
+        quint32 fragmentIndex = 0xFFFFFFFF;
+        quint32 fragmentOffset = 0;
+        QList<quint32> blockSizes;
+        quint32 dirBlock = 0;
+        quint32 dirOffset = 0;
+        quint32 dirSize = 0;
+        QByteArray target;
+    };
+
+    struct DirectoryEntry {
+        SquashfsEntry entry;
+        quint64 inode = 0;
+    };
+
+    struct MetadataBlock {
+        QByteArray data;
+        quint64 next = 0;
+    };
+
+    static const int maxSymLinkDepth;
+
+    QFile m_file;
+    const qint64 m_offset;
+    uchar* m_map = nullptr;
+    const uchar* m_data = nullptr;
+    qint64 m_size = 0;
+
+    quint16 m_compression = 0;
+    quint32 m_blockSize = 0;
+    quint32 m_fragmentCount = 0;
+    quint64 m_rootInode = 0;
+    quint64 m_inodeTable = 0;
+    quint64 m_directoryTable = 0;
+    quint64 m_fragmentTable = 0;
+    QHash<quint64, MetadataBlock> m_metadataCache;
+    QHash<quint32, QByteArray> m_fragmentCache;
+
+    const uchar* bytes(quint64 offset, quint64 size) const;
+    bool decompress(const uchar* source, qint64 sourceSize, QByteArray& out, qint64 maxSize) const;
+    bool readMetadataBlock(quint64 position, const MetadataBlock*& block);
+    bool readMetadata(quint64 position, quint32 offset, qint64 size, QByteArray& out);
+    bool readInode(quint64 ref, Inode& inode);
+    bool readDirectory(const Inode& dir, QList<DirectoryEntry>& entries);
+    bool readFragment(quint32 index, QByteArray& fragment);
+    bool lookup(const QString& path, bool followLast, Inode& inode, QString* resolvedPath = nullptr, int depth = 0);
+};
+
+#endif // SQUASHFSUTIL_H
@@ -3,10 +3,211 @@
 
 #include <QDateTime>
 #include <QStringList>
+#include <QStringView>
+#include <QTimeZone>
 
 namespace StringUtil {
 
-inline QDateTime parseDateTime(const QString &input) {
+namespace detail {
+
+inline bool isDigit(QChar c) { return c.unicode() >= u'0' && c.unicode() <= u'9'; }
+
+// Reads exactly count digits at pos
+inline bool readNumber(QStringView s, qsizetype &pos, int count, int &out) {
+    if (pos + count > s.size())
+        return false;
+
+    int value = 0;
+    for (int i = 0; i < count; ++i) {
+        const QChar c = s[pos + i];
+        if (!isDigit(c))
+            return false;
+        value = value * 10 + (c.unicode() - u'0');
+    }
+
+    pos += count;
+    out = value;
+    return true;
+}
+
+inline bool readChar(QStringView s, qsizetype &pos, char16_t c) {
+    if (pos < s.size() && s[pos] == c) {
+        ++pos;
+        return true;
+    }
+    return false;
+}
+
+// HH:mm[:ss[.zzz]], seconds and fractions are only optional in ISO 8601
+inline bool readTime(QStringView s, qsizetype &pos, bool iso, QTime &time) {
+    int hour = 0, minute = 0, second = 0, msec = 0;
+    if (!readNumber(s, pos, 2, hour) || !readChar(s, pos, u':') || !readNumber(s, pos, 2, minute))
+        return false;
+
+    if (readChar(s, pos, u':')) {
+        if (!readNumber(s, pos, 2, second))
+            return false;
+
+        if (iso && (readChar(s, pos, u'.') || readChar(s, pos, u','))) {
+            // Rounded to milliseconds like Qt::ISODateWithMs
+            double fraction = 0, scale = 0.1;
+            const qsizetype start = pos;
+            for (; pos < s.size() && isDigit(s[pos]); ++pos, scale /= 10)
+                fraction += (s[pos].unicode() - u'0') * scale;
+            if (pos == start)
+                return false;
+            msec = qMin(qRound(fraction * 1000), 999);
+        }
+    } else if (!iso) {
+        return false;
+    }
+
+    time = QTime(hour, minute, second, msec);
+    return time.isValid();
+}
+
+// Z, ±HH, ±HHmm or ±HH:mm
+inline bool readOffset(QStringView s, qsizetype &pos, QTimeZone &zone) {
+    if (readChar(s, pos, u'Z')) {
+        zone = QTimeZone::UTC;
+        return true;
+    }
+
+    int sign = 0;
+    if (readChar(s, pos, u'+'))
+        sign = 1;
+    else if (readChar(s, pos, u'-'))
+        sign = -1;
+    else
+        return false;
+
+    int hours = 0, minutes = 0;
+    if (!readNumber(s, pos, 2, hours))
+        return false;
+    if (pos < s.size()) {
+        readChar(s, pos, u':');
+        if (!readNumber(s, pos, 2, minutes))
+            return false;
+    }
+
+    if (hours > 23 || minutes > 59)
+        return false;
+
+    zone = QTimeZone::fromSecondsAheadOfUtc(sign * (hours * 3600 + minutes * 60));
+    return true;
+}
+
+// yyyy-MM-dd[(T| )HH:mm[:ss[.zzz]][offset]]
+inline QDateTime parseIso(QStringView s) {
+    qsizetype pos = 0;
+    int year = 0, month = 0, day = 0;
+    if (!readNumber(s, pos, 4, year) || !readChar(s, pos, u'-') || !readNumber(s, pos, 2, month)
+        || !readChar(s, pos, u'-') || !readNumber(s, pos, 2, day))
+        return QDateTime();
+
+    const QDate date(year, month, day);
+    if (!date.isValid())
+        return QDateTime();
+    if (pos == s.size())
+        return QDateTime(date, QTime(0, 0));
+
+    QTime time;
+    if (!(readChar(s, pos, u'T') || readChar(s, pos, u' ')) || !readTime(s, pos, true, time))
+        return QDateTime();
+    if (pos == s.size())
+        return QDateTime(date, time);
+
+    QTimeZone zone;
+    if (!readOffset(s, pos, zone) || pos != s.size())
+        return QDateTime();
+    return QDateTime(date, time, zone);
+}
+
+// [ddd, ]d MMM yyyy HH:mm[:ss] (±HHmm|GMT|UT|UTC)
+inline QDateTime parseRfc2822(QStringView s) {
+    static constexpr char16_t months[] = u"janfebmaraprmayjunjulaugsepoctnovdec";
+    qsizetype pos = 0;
+
+    // Day name is informational only
+    if (s.size() > 4 && s[0].isLetter() && s[3] == u',') {
+        pos = 4;
+        while (readChar(s, pos, u' ')) {}
+    }
+
+    int day = 0, month = 0, year = 0;
+    if (!readNumber(s, pos, 2, day) && !readNumber(s, pos, 1, day))
+        return QDateTime();
+    if (!readChar(s, pos, u' ') || pos + 3 > s.size())
+        return QDateTime();
+
+    for (int i = 0; i < 12 && !month; ++i) {
+        bool match = true;
+        for (int j = 0; j < 3 && match; ++j)
+            match = s[pos + j].toLower() == QChar(months[i * 3 + j]);
+        if (match)
+            month = i + 1;
+    }
+    pos += 3;
+
+    QTime time;
+    if (!month || !readChar(s, pos, u' ') || !readNumber(s, pos, 4, year) || !readChar(s, pos, u' ')
+        || !readTime(s, pos, true, time) || time.msec() != 0 || !readChar(s, pos, u' '))
+        return QDateTime();
+
+    const QDate date(year, month, day);
+    if (!date.isValid())
+        return QDateTime();
+
+    const QStringView zoneName = s.mid(pos);
+    if (zoneName == u"GMT" || zoneName == u"UT" || zoneName == u"UTC")
+        return QDateTime(date, time, QTimeZone::UTC);
+
+    int sign = zoneName.startsWith(u'-') ? -1 : 1;
+    int hours = 0, minutes = 0;
+    if (!(readChar(s, pos, u'+') || readChar(s, pos, u'-')) || !readNumber(s, pos, 2, hours)
+        || !readNumber(s, pos, 2, minutes) || pos != s.size() || minutes > 59)
+        return QDateTime();
+    return QDateTime(date, time, QTimeZone::fromSecondsAheadOfUtc(sign * (hours * 3600 + minutes * 60)));
+}
+
+// yyyy/MM/dd HH:mm:ss, dd/MM/yyyy[ HH:mm:ss] or MM/dd/yyyy[ HH:mm:ss], day first wins
+inline QDateTime parseSlash(QStringView s) {
+    qsizetype pos = 0;
+    int first = 0, second = 0, third = 0;
+    const bool yearFirst = s.size() > 4 && s[4] == u'/';
+    if (!readNumber(s, pos, yearFirst ? 4 : 2, first) || !readChar(s, pos, u'/') || !readNumber(s, pos, 2, second)
+        || !readChar(s, pos, u'/') || !readNumber(s, pos, yearFirst ? 2 : 4, third))
+        return QDateTime();
+
+    QTime time(0, 0);
+    if (pos != s.size()) {
+        if (!readChar(s, pos, u' ') || !readTime(s, pos, false, time) || pos != s.size())
+            return QDateTime();
+    } else if (yearFirst) {
+        return QDateTime();
+    }
+
+    QDate date = yearFirst ? QDate(first, second, third) : QDate(third, second, first);
+    if (!date.isValid() && !yearFirst)
+        date = QDate(third, first, second);
+    return date.isValid() ? QDateTime(date, time) : QDateTime();
+}
+
+// Unix time, in seconds or milliseconds
+inline QDateTime parseEpoch(QStringView s) {
+    if (s.size() < 9 || s.size() > 13 || s.size() == 12)
+        return QDateTime();
+
+    qint64 value = 0;
+    for (QChar c : s)
+        value = value * 10 + (c.unicode() - u'0');
+
+    return s.size() == 13 ? QDateTime::fromMSecsSinceEpoch(value, QTimeZone::UTC)
+                          : QDateTime::fromSecsSinceEpoch(value, QTimeZone::UTC);
+}
+
+// Shapes the scanners do not know about
+inline QDateTime parseWithFormats(const QString &input) {
     static const QList<QString> customFormats = {
         "yyyy-MM-dd HH:mm:ss",
         "yyyy/MM/dd HH:mm:ss",
@@ -40,4 +241,38 @@ inline QDateTime parseDateTime(const QString &input) {
 
 }
 
+/**
+ * @brief Parses a date in any of the shapes update sources use. The shape is
+ * picked from the leading characters and scanned in a single pass, only
+ * unrecognized input goes through QDateTime::fromString
+ * @param input Date string, ie "2024-05-01T10:00:00Z" or "Wed, 01 May 2024 10:00:00 GMT"
+ * @return Parsed date, invalid if nothing matched
+ */
+inline QDateTime parseDateTime(const QString &input) {
+    const QStringView s = QStringView(input).trimmed();
+    if (s.isEmpty())
+        return QDateTime();
+
+    QDateTime dt;
+    qsizetype digits = 0;
+    while (digits < s.size() && detail::isDigit(s[digits]))
+        ++digits;
+
+    if (digits == s.size())
+        dt = detail::parseEpoch(s);
+    else if (digits == 4 && s[digits] == u'-')
+        dt = detail::parseIso(s);
+    else if ((digits == 4 || digits == 2) && s[digits] == u'/')
+        dt = detail::parseSlash(s);
+    else if (digits <= 2 && (digits > 0 ? s[digits] == u' ' : s[0].isLetter()))
+        dt = detail::parseRfc2822(s);
+
+    if (dt.isValid())
+        return dt;
+
+    return detail::parseWithFormats(input);
+}
+
+}
+
 #endif // STRINGUTIL_H
@@ -1,8 +1,8 @@
 #include "terminalutil.h"
 #include "managers/errormanager.h"
 #include "managers/settingsmanager.h"
+#include "utils/executableutil.h"
 
-#include <QStandardPaths>
 #include <QProcessEnvironment>
 #include <QSet>
 #include <QStringList>
@@ -53,7 +53,7 @@ const QString TerminalUtil::detectTerminal()
 
     // Find the first executable
     for (const QString &term : merged) {
-        QString path = QStandardPaths::findExecutable(term);
+        QString path = ExecutableUtil::findExecutable(term);
         if (!path.isEmpty()) {
             return path;
         }
@@ -64,7 +64,7 @@ const QString TerminalUtil::detectTerminal()
 
 const bool TerminalUtil::terminalExists(const QString& path)
 {
-    QString execPath = QStandardPaths::findExecutable(path);
+    QString execPath = ExecutableUtil::findExecutable(path);
     return !execPath.isEmpty();
 }
 
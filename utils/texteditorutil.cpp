@@ -1,6 +1,7 @@
 #include "texteditorutil.h"
 #include "managers/errormanager.h"
 #include "managers/settingsmanager.h"
+#include "utils/executableutil.h"
 
 
 #include <QProcess>
@@ -46,7 +47,7 @@ const bool TextEditorUtil::textEditorExists(const QString& path)
         return false;
     }
 
-    return !QStandardPaths::findExecutable(path).isEmpty();
+    return !ExecutableUtil::findExecutable(path).isEmpty();
 }
 
 const bool TextEditorUtil::launchInTextEditor(const QString &path)
@@ -116,7 +117,7 @@ const QString TextEditorUtil::detectTextEditorByPath()
     QStringList textEditors = { "gedit", "kate", "xed", "mousepad", "code", "subl", "nano", "vim" };
 
     for (const QString &c : textEditors) {
-        QString path = QStandardPaths::findExecutable(c);
+        QString path = ExecutableUtil::findExecutable(c);
         if (!path.isEmpty())
             return c;
     }
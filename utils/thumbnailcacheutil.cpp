@@ -0,0 +1,181 @@
+#include "thumbnailcacheutil.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr quint32 thumbnailMagic = 0x42414c54; // "BALT"
+constexpr quint32 thumbnailVersion = 1;
+
+// Padded to 64 bytes so the pixels stay aligned in the mapping
+struct ThumbnailHeader {
+    quint32 magic;
+    quint32 version;
+    qint64 iconModified;
+    qint64 iconSize;
+    qint32 width;
+    qint32 height;
+    qint32 bytesPerLine;
+    quint32 format;
+    quint8 reserved[24];
+};
+static_assert(sizeof(ThumbnailHeader) == 64, "thumbnail header must stay 64 bytes");
+
+struct Mapping {
+    void* data;
+    size_t size;
+};
+
+void unmapThumbnail(void* info)
+{
+    auto* mapping = static_cast<Mapping*>(info);
+    ::munmap(mapping->data, mapping->size);
+    delete mapping;
+}
+
+const qint64 toNs(const struct timespec& ts)
+{
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+}
+
+// ----------------- Public -----------------
+
+ThumbnailCacheUtil::ThumbnailCacheUtil() {}
+
+const int ThumbnailCacheUtil::defaultSize = 192;
+
+const QImage ThumbnailCacheUtil::load(const QString& iconPath, int size)
+{
+    if (iconPath.isEmpty() || size <= 0)
+        return QImage();
+
+    struct stat st;
+    if (::stat(QFile::encodeName(iconPath).constData(), &st) != 0)
+        return QImage();
+
+    const QString filePath = thumbnailPath(iconPath, size);
+    QImage image = read(filePath, toNs(st.st_mtim), st.st_size);
+    if (!image.isNull())
+        return image;
+
+    image = decode(iconPath, size);
+    if (!image.isNull())
+        write(filePath, image, toNs(st.st_mtim), st.st_size);
+
+    return image;
+}
+
+// ----------------- Private -----------------
+
+const QString ThumbnailCacheUtil::thumbnailPath(const QString& iconPath, int size)
+{
+    const QByteArray hash = QCryptographicHash::hash(QFile::encodeName(iconPath), QCryptographicHash::Sha1).toHex();
+    return QString("%1/thumbnails/%2-%3.argb")
+        .arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation), QString::fromLatin1(hash))
+        .arg(size);
+}
+
+const QImage ThumbnailCacheUtil::read(const QString& filePath, qint64 iconModified, qint64 iconSize)
+{
+    int fd = ::open(QFile::encodeName(filePath).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return QImage();
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < qint64(sizeof(ThumbnailHeader))) {
+        ::close(fd);
+        return QImage();
+    }
+
+    // The mapping outlives the descriptor, so no file stays open per cached image
+    void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+        return QImage();
+
+    const auto* header = static_cast<const ThumbnailHeader*>(data);
+    const qint64 pixelBytes = qint64(header->bytesPerLine) * header->height;
+    const bool valid = header->magic == thumbnailMagic
+                       && header->version == thumbnailVersion
+                       && header->iconModified == iconModified
+                       && header->iconSize == iconSize
+                       && header->width > 0 && header->height > 0
+                       && header->bytesPerLine >= header->width * 4
+                       && header->format == QImage::Format_ARGB32_Premultiplied
+                       && qint64(sizeof(ThumbnailHeader)) + pixelBytes <= st.st_size;
+
+    if (!valid) {
+        ::munmap(data, st.st_size);
+        return QImage();
+    }
+
+    auto* mapping = new Mapping { data, size_t(st.st_size) };
+    return QImage(static_cast<const uchar*>(data) + sizeof(ThumbnailHeader),
+                  header->width, header->height, header->bytesPerLine,
+                  QImage::Format_ARGB32_Premultiplied, unmapThumbnail, mapping);
+}
+
+void ThumbnailCacheUtil::write(const QString& filePath, const QImage& image, qint64 iconModified, qint64 iconSize)
+{
+    const QImage pixels = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    ThumbnailHeader header {};
+    header.magic = thumbnailMagic;
+    header.version = thumbnailVersion;
+    header.iconModified = iconModified;
+    header.iconSize = iconSize;
+    header.width = pixels.width();
+    header.height = pixels.height();
+    header.bytesPerLine = pixels.bytesPerLine();
+    header.format = QImage::Format_ARGB32_Premultiplied;
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+    // Written atomically, so a concurrent reader never maps a partial file
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write thumbnail:" << filePath;
+        return;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(pixels.constBits()), pixels.sizeInBytes());
+    if (!file.commit())
+        qWarning() << "Failed to write thumbnail:" << filePath;
+}
+
+const QImage ThumbnailCacheUtil::decode(const QString& iconPath, int size)
+{
+    QImageReader reader(iconPath);
+    const QSize bounds(size, size);
+    const QSize original = reader.size();
+
+    // Vector formats are rasterised straight at the target size, rasters only scale down
+    const QByteArray format = reader.format();
+    const bool isVector = format == "svg" || format == "svgz";
+    if (original.isValid() && (original.width() > size || original.height() > size || isVector))
+        reader.setScaledSize(original.scaled(bounds, Qt::KeepAspectRatio));
+
+    QImage image = reader.read();
+    if (image.isNull())
+        return QImage();
+
+    if (image.width() > size || image.height() > size)
+        image = image.scaled(bounds, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    return image;
+}
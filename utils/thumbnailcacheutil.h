@@ -0,0 +1,33 @@
+#ifndef THUMBNAILCACHEUTIL_H
+#define THUMBNAILCACHEUTIL_H
+
+#include <QImage>
+#include <QString>
+
+class ThumbnailCacheUtil
+{
+public:
+    ThumbnailCacheUtil();
+
+    static const int defaultSize;
+
+    /**
+     * @brief Gets a thumbnail of the icon, fitting in size x size.
+     * Thumbnails are kept on disk as raw premultiplied ARGB keyed by icon path,
+     * mtime and size, and are memory mapped straight into the image on a hit.
+     * On a miss the icon is decoded at the target size and the thumbnail written.
+     * Safe to call from any thread.
+     * @param iconPath Path to the icon file
+     * @param size Size of the bounding square in pixels
+     * @return Thumbnail, or a null image if the icon could not be read
+     */
+    static const QImage load(const QString& iconPath, int size = defaultSize);
+
+private:
+    static const QString thumbnailPath(const QString& iconPath, int size);
+    static const QImage read(const QString& filePath, qint64 iconModified, qint64 iconSize);
+    static void write(const QString& filePath, const QImage& image, qint64 iconModified, qint64 iconSize);
+    static const QImage decode(const QString& iconPath, int size);
+};
+
+#endif // THUMBNAILCACHEUTIL_H
@@ -0,0 +1,236 @@
+#include "githubbatchupdater.h"
+#include "jsonupdater.h"
+#include "managers/settingsmanager.h"
+#include "utils/regexutil.h"
+#include "utils/updater/updaterscheduler.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QNetworkRequest>
+#include <QProcessEnvironment>
+#include <QRegularExpression>
+
+// ----------------- Public -----------------
+
+GithubBatchUpdater::GithubBatchUpdater(QObject *parent) : QObject(parent) {}
+
+const bool GithubBatchUpdater::canBatch(const UpdaterSettings &settings)
+{
+    if (settings.type != "json")
+        return false;
+
+    QString owner, name;
+    bool latestOnly = true;
+    if (!parseUrl(settings.url, owner, name, latestOnly))
+        return false;
+
+    // Only the fields mapped by toRestRelease can be batched
+    QStringList fields = { settings.versionField, settings.downloadField };
+    if (!settings.dateField.isEmpty())
+        fields << settings.dateField;
+    for (const auto &filter : settings.filters)
+        fields << filter.field;
+
+    for (const auto &field : fields) {
+        if (!supportedFields.contains(field))
+            return false;
+    }
+
+    // The GraphQL API always requires a token, a mock endpoint does not
+    if (endpoint().host() != "api.github.com")
+        return true;
+
+    const auto updateHeaders = SettingsManager::instance()->getUpdateHeaders();
+    for (const auto &header : updateHeaders) {
+        if (header.header.compare("Authorization", Qt::CaseInsensitive) == 0 && !header.value.isEmpty()
+            && (header.website.isEmpty() || endpoint().toString().contains(header.website)))
+            return true;
+    }
+
+    return false;
+}
+
+const QUrl GithubBatchUpdater::endpoint()
+{
+    const QString url = QProcessEnvironment::systemEnvironment().value("BAL_GITHUB_GRAPHQL_URL");
+    return QUrl(url.isEmpty() ? "https://api.github.com/graphql" : url);
+}
+
+void GithubBatchUpdater::add(const QString &key, const UpdaterSettings &settings)
+{
+    Check check;
+    check.key = key;
+    check.settings = settings;
+    parseUrl(settings.url, check.owner, check.name, check.latestOnly);
+    m_checks.append(check);
+}
+
+void GithubBatchUpdater::fetchUpdatesAsync()
+{
+    m_releases.clear();
+    m_failed.clear();
+
+    if (m_checks.isEmpty()) {
+        QTimer::singleShot(0, this, &GithubBatchUpdater::updatesReady);
+        return;
+    }
+
+    const QUrl url = endpoint();
+    const auto updateHeaders = SettingsManager::instance()->getUpdateHeaders();
+
+    for (int i = 0; i < m_checks.count(); i += maxReposPerRequest) {
+        const QList<Check> batch = m_checks.mid(i, maxReposPerRequest);
+
+        QNetworkRequest req(url);
+        req.setHeader(QNetworkRequest::UserAgentHeader, "BarryAppLauncher");
+        req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+
+        // Apply custom user update headers, ie the token
+        for (const auto &header : updateHeaders) {
+            if (header.header.isEmpty() || header.value.isEmpty())
+                continue;
+
+            if (header.website.isEmpty() || url.toString().contains(header.website))
+                req.setRawHeader(header.header.toUtf8(), header.value.toUtf8());
+        }
+
+        m_pending++;
+        UpdaterScheduler::instance()->schedulePost(req, buildQuery(batch), UpdaterScheduler::Normal, this,
+                                                   [this, batch](QNetworkReply *reply) {
+            onBatchFinished(reply, batch);
+        });
+    }
+}
+
+// ----------------- Private -----------------
+
+const int GithubBatchUpdater::maxReposPerRequest = 25;
+const int GithubBatchUpdater::maxReleasesPerRepo = 30;
+const int GithubBatchUpdater::maxAssetsPerRelease = 50;
+const QStringList GithubBatchUpdater::supportedFields = {
+    "tag_name", "name", "published_at", "created_at", "prerelease", "draft", "html_url",
+    "assets[*].browser_download_url", "assets[*].name"
+};
+
+void GithubBatchUpdater::onBatchFinished(QNetworkReply *reply, const QList<Check> &batch)
+{
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QByteArray data = reply->readAll();
+    reply->deleteLater();
+
+    const QJsonObject root = QJsonDocument::fromJson(data).object();
+    const QJsonObject repositories = root["data"].toObject();
+
+    if (status < 200 || status >= 300 || repositories.isEmpty()) {
+        qWarning() << "GitHub batch check failed with status" << status << "- checking one by one";
+        for (const auto &check : batch)
+            m_failed.append(check.key);
+        finishRequest();
+        return;
+    }
+
+    for (int i = 0; i < batch.count(); ++i) {
+        const Check &check = batch[i];
+        const QJsonValue repository = repositories[QString("r%1").arg(i)];
+
+        // Missing or inaccessible repository, the rest api reports it properly
+        if (!repository.isObject()) {
+            m_failed.append(check.key);
+            continue;
+        }
+
+        // Shaped like the rest api, so the user's fields, patterns and filters apply unchanged
+        QByteArray rest;
+        if (check.latestOnly) {
+            const QJsonValue latest = repository.toObject()["latestRelease"];
+            rest = QJsonDocument(latest.isObject() ? toRestRelease(latest.toObject()) : QJsonObject())
+                       .toJson(QJsonDocument::Compact);
+        } else {
+            QJsonArray releases;
+            const QJsonArray nodes = repository.toObject()["releases"].toObject()["nodes"].toArray();
+            for (const auto &node : nodes)
+                releases.append(toRestRelease(node.toObject()));
+            rest = QJsonDocument(releases).toJson(QJsonDocument::Compact);
+        }
+
+        JsonUpdater parser(check.settings);
+        parser.parseData(rest);
+        m_releases.insert(check.key, parser.releases());
+    }
+
+    finishRequest();
+}
+
+void GithubBatchUpdater::finishRequest()
+{
+    if (--m_pending == 0)
+        emit updatesReady();
+}
+
+const bool GithubBatchUpdater::parseUrl(const QString &url, QString &owner, QString &name, bool &latestOnly)
+{
+    static const QRegularExpression re = RegexUtil::get(R"(^https://api\.github\.com/repos/([^/]+)/([^/]+)/releases(/latest)?/?$)");
+
+    const QRegularExpressionMatch match = re.match(url);
+    if (!match.hasMatch())
+        return false;
+
+    owner = match.captured(1);
+    name = match.captured(2);
+    latestOnly = !match.captured(3).isEmpty();
+    return true;
+}
+
+const QByteArray GithubBatchUpdater::buildQuery(const QList<Check> &batch)
+{
+    const QString releaseFields = QString(
+        "tagName name publishedAt createdAt isPrerelease isDraft url "
+        "releaseAssets(first: %1) { nodes { name downloadUrl } }").arg(maxAssetsPerRelease);
+
+    // Owner and name are passed as variables, never spliced into the query
+    QStringList declarations;
+    QStringList selections;
+    QJsonObject variables;
+
+    for (int i = 0; i < batch.count(); ++i) {
+        declarations << QString("$o%1: String!, $n%1: String!").arg(i);
+        variables[QString("o%1").arg(i)] = batch[i].owner;
+        variables[QString("n%1").arg(i)] = batch[i].name;
+
+        if (batch[i].latestOnly)
+            selections << QString("r%1: repository(owner: $o%1, name: $n%1) { latestRelease { %2 } }")
+                              .arg(i).arg(releaseFields);
+        else
+            selections << QString("r%1: repository(owner: $o%1, name: $n%1) { "
+                                  "releases(first: %2, orderBy: {field: CREATED_AT, direction: DESC}) { nodes { %3 } } }")
+                              .arg(i).arg(maxReleasesPerRepo).arg(releaseFields);
+    }
+
+    QJsonObject body;
+    body["query"] = QString("query(%1) { %2 }").arg(declarations.join(", "), selections.join(" "));
+    body["variables"] = variables;
+    return QJsonDocument(body).toJson(QJsonDocument::Compact);
+}
+
+const QJsonObject GithubBatchUpdater::toRestRelease(const QJsonObject &release)
+{
+    QJsonArray assets;
+    const QJsonArray nodes = release["releaseAssets"].toObject()["nodes"].toArray();
+    for (const auto &node : nodes) {
+        QJsonObject asset;
+        asset["name"] = node.toObject()["name"];
+        asset["browser_download_url"] = node.toObject()["downloadUrl"];
+        assets.append(asset);
+    }
+
+    QJsonObject rest;
+    rest["tag_name"] = release["tagName"];
+    rest["name"] = release["name"];
+    rest["published_at"] = release["publishedAt"];
+    rest["created_at"] = release["createdAt"];
+    rest["prerelease"] = release["isPrerelease"];
+    rest["draft"] = release["isDraft"];
+    rest["html_url"] = release["url"];
+    rest["assets"] = assets;
+    return rest;
+}
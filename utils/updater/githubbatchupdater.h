@@ -0,0 +1,82 @@
+#ifndef GITHUBBATCHUPDATER_H
+#define GITHUBBATCHUPDATER_H
+
+#include "utils/updater/updaterfactory.h"
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QNetworkReply>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+
+class GithubBatchUpdater : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GithubBatchUpdater(QObject *parent = nullptr);
+
+    /**
+     * @brief Checks if the settings are a GitHub releases check that can be batched,
+     * ie created from the GitHub presets, and if GraphQL credentials are configured
+     * @param settings Updater settings of the appimage
+     * @return Bool indicating if the settings can be batched
+     */
+    static const bool canBatch(const UpdaterSettings &settings);
+    /**
+     * @brief Gets the GraphQL endpoint, overridable with BAL_GITHUB_GRAPHQL_URL ie to test against a mock
+     * @return Url of the endpoint
+     */
+    static const QUrl endpoint();
+
+    /**
+     * @brief Adds a check to the batch
+     * @param key Key the releases are reported under, ie the appimage path
+     * @param settings Updater settings of the appimage, canBatch must be true
+     */
+    void add(const QString &key, const UpdaterSettings &settings);
+    /**
+     * @brief Queries every added repository, in as few requests as possible
+     */
+    void fetchUpdatesAsync();
+
+    const QHash<QString, QList<UpdaterRelease>>& releases() const { return m_releases; }
+    /**
+     * @brief Keys whose repository could not be queried, to be checked one by one instead
+     */
+    const QStringList& failed() const { return m_failed; }
+
+signals:
+    void updatesReady();
+
+private:
+    struct Check {
+        QString key;
+        UpdaterSettings settings;
+        QString owner;
+        QString name;
+        bool latestOnly = true;
+    };
+
+    static const int maxReposPerRequest;
+    static const int maxReleasesPerRepo;
+    static const int maxAssetsPerRelease;
+    static const QStringList supportedFields;
+
+    QList<Check> m_checks;
+    QHash<QString, QList<UpdaterRelease>> m_releases;
+    QStringList m_failed;
+    int m_pending = 0;
+
+    void onBatchFinished(QNetworkReply *reply, const QList<Check> &batch);
+    void finishRequest();
+
+    static const bool parseUrl(const QString &url, QString &owner, QString &name, bool &latestOnly);
+    static const QByteArray buildQuery(const QList<Check> &batch);
+    static const QJsonObject toRestRelease(const QJsonObject &release);
+};
+
+#endif // GITHUBBATCHUPDATER_H
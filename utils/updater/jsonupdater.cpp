@@ -1,6 +1,7 @@
 #include "jsonupdater.h"
 #include "managers/errormanager.h"
 #include "utils/jsonutil.h"
+#include "utils/regexutil.h"
 
 #include <QNetworkRequest>
 #include <QNetworkReply>
@@ -33,21 +34,31 @@ void JsonUpdater::parseData(const QByteArray &data)
         return;
     }
 
-    QRegularExpression downloadRe(m_settings.downloadPattern);
+    const QRegularExpression downloadRe = RegexUtil::get(m_settings.downloadPattern);
     if (!downloadRe.isValid()) {
         ErrorManager::instance()->reportError("Invalid download regex: " + m_settings.downloadPattern);
 
     }
 
-    QRegularExpression versionRe(m_settings.versionPattern);
+    const QRegularExpression versionRe = RegexUtil::get(m_settings.versionPattern);
     if (!versionRe.isValid()) {
         ErrorManager::instance()->reportError("Invalid version regex: " + m_settings.versionPattern);
 
     }
 
+    // Compile every path once, they are evaluated against each release candidate
+    const JsonPath versionPath(m_settings.versionField);
+    const JsonPath datePath(m_settings.dateField);
+    const JsonPath downloadPath(m_settings.downloadField);
+    QList<JsonPath> filterPaths;
+    QList<QRegularExpression> filterRes;
+    for (const UpdaterFilter &f : m_settings.filters) {
+        filterPaths.append(JsonPath(f.field));
+        filterRes.append(RegexUtil::get(f.pattern));
+    }
+
     // Expand releases from the root
-    QList<QJsonValue> releaseCandidates =
-        root.isArray() ? JsonUtil::getValuesByPath(root, "[*]") : QList<QJsonValue>{ root };
+    const QJsonArray releaseCandidates = root.isArray() ? root.toArray() : QJsonArray{ root };
 
     for (const QJsonValue &releaseVal : releaseCandidates) {
         if (!releaseVal.isObject())
@@ -57,13 +68,13 @@ void JsonUpdater::parseData(const QByteArray &data)
 
         // Apply filters
         bool include = true;
-        for (const UpdaterFilter &f : m_settings.filters) {
-            QList<QJsonValue> vals = JsonUtil::getValuesByPath(obj, f.field);
+        for (qsizetype i = 0; i < m_settings.filters.size(); ++i) {
+            const QJsonValue val = filterPaths.at(i).first(obj);
             QString fieldVal;
-            if (!vals.isEmpty())
-                fieldVal = vals.first().toVariant().toString();
+            if (!val.isUndefined())
+                fieldVal = val.toVariant().toString();
 
-            QRegularExpression re(f.pattern);
+            const QRegularExpression &re = filterRes.at(i);
             if (!re.isValid() || !re.match(fieldVal).hasMatch()) {
                 include = false;
                 break;
@@ -74,9 +85,9 @@ void JsonUpdater::parseData(const QByteArray &data)
         // Extract version
         QString version;
         {
-            QList<QJsonValue> vals = JsonUtil::getValuesByPath(obj, m_settings.versionField);
-            if (!vals.isEmpty()) {
-                version = vals.first().toVariant().toString();
+            const QJsonValue val = versionPath.first(obj);
+            if (!val.isUndefined()) {
+                version = val.toVariant().toString();
                 if (!versionRe.pattern().isEmpty()) {
                     QRegularExpressionMatch match = versionRe.match(version);
                     if (match.hasMatch()) {
@@ -89,15 +100,15 @@ void JsonUpdater::parseData(const QByteArray &data)
         // Extract date
         QString date;
         {
-            QList<QJsonValue> vals = JsonUtil::getValuesByPath(obj, m_settings.dateField);
-            if (!vals.isEmpty())
-                date = vals.first().toVariant().toString();
+            const QJsonValue val = datePath.first(obj);
+            if (!val.isUndefined())
+                date = val.toVariant().toString();
         }
 
         // Extract download url
         QString download;
         {
-            const QList<QJsonValue> candidates = JsonUtil::getValuesByPath(obj, m_settings.downloadField);
+            const QList<QJsonValue> candidates = downloadPath.values(obj);
             for (const QJsonValue &v : candidates) {
                 if (!v.isString()) continue;
                 const QString url = v.toString();
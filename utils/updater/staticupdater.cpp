@@ -1,5 +1,6 @@
 #include "staticupdater.h"
 #include "utils/jsonutil.h"
+#include "utils/regexutil.h"
 
 StaticUpdater::StaticUpdater(QObject *parent) : IUpdater(parent) { m_headersOnly = true; }
 StaticUpdater::StaticUpdater(const UpdaterSettings &settings, QObject *parent) : IUpdater(settings, parent) { m_headersOnly = true; }
@@ -23,7 +24,7 @@ void StaticUpdater::parseData(const QByteArray &data)
         return;
     }
 
-    QRegularExpression versionRe(m_settings.versionPattern);
+    const QRegularExpression versionRe = RegexUtil::get(m_settings.versionPattern);
     if (!versionRe.isValid()) {
         ErrorManager::instance()->reportError("Invalid version regex: " + m_settings.versionPattern);
 
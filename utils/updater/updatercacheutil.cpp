@@ -0,0 +1,170 @@
+#include "updatercacheutil.h"
+#include "utils/updater/updaterfactory.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+
+constexpr quint32 cacheMagic = 0x42414c55; // "BALU"
+constexpr quint32 cacheVersion = 1;
+
+struct ParsedReleases {
+    QString settingsKey;
+    QList<UpdaterRelease> releases;
+};
+
+// Parsing is cheap next to the network, so these are not persisted
+QHash<QString, ParsedReleases> parsedReleases;
+
+}
+
+// ----------------- Public -----------------
+
+UpdaterCacheUtil::UpdaterCacheUtil() {}
+
+const int UpdaterCacheUtil::freshSeconds = 10 * 60;
+
+const bool UpdaterCacheUtil::lookup(const QString& key, UpdaterCacheEntry& entry)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_entries.constFind(key);
+    if (it != m_entries.cend()) {
+        entry = it.value();
+        return true;
+    }
+
+    UpdaterCacheEntry stored;
+    if (!read(key, stored, nullptr))
+        return false;
+
+    m_entries.insert(key, stored);
+    entry = stored;
+    return true;
+}
+
+const QByteArray UpdaterCacheUtil::readData(const QString& key)
+{
+    QMutexLocker locker(&m_mutex);
+
+    UpdaterCacheEntry stored;
+    QByteArray data;
+    if (!read(key, stored, &data))
+        return QByteArray();
+
+    return data;
+}
+
+const bool UpdaterCacheUtil::isFresh(const UpdaterCacheEntry& entry)
+{
+    return entry.isValid() && entry.fetched.secsTo(QDateTime::currentDateTimeUtc()) < freshSeconds;
+}
+
+void UpdaterCacheUtil::store(const QString& key, const UpdaterCacheEntry& entry, const QByteArray& data)
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.insert(key, entry);
+    parsedReleases.remove(key);
+    write(key, entry, data);
+}
+
+void UpdaterCacheUtil::touch(const QString& key)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+        return;
+
+    // The body is only kept on disk, so the file is rewritten with it
+    UpdaterCacheEntry stored;
+    QByteArray data;
+    if (!read(key, stored, &data)) {
+        m_entries.erase(it);
+        return;
+    }
+
+    it->fetched = QDateTime::currentDateTimeUtc();
+    write(key, it.value(), data);
+}
+
+const bool UpdaterCacheUtil::lookupReleases(const QString& key, const QString& settingsKey, QList<UpdaterRelease>& releases)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto it = parsedReleases.constFind(key);
+    if (it == parsedReleases.cend() || it->settingsKey != settingsKey)
+        return false;
+
+    releases = it->releases;
+    return true;
+}
+
+void UpdaterCacheUtil::storeReleases(const QString& key, const QString& settingsKey, const QList<UpdaterRelease>& releases)
+{
+    QMutexLocker locker(&m_mutex);
+    parsedReleases.insert(key, ParsedReleases { settingsKey, releases });
+}
+
+// ----------------- Private -----------------
+
+QMutex UpdaterCacheUtil::m_mutex;
+QHash<QString, UpdaterCacheEntry> UpdaterCacheUtil::m_entries;
+
+const QString UpdaterCacheUtil::cacheFilePath(const QString& key)
+{
+    const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/updates/" + QString::fromLatin1(hash) + ".cache";
+}
+
+const bool UpdaterCacheUtil::read(const QString& key, UpdaterCacheEntry& entry, QByteArray* data)
+{
+    QFile file(cacheFilePath(key));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_8);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QString storedKey;
+    in >> magic >> version >> storedKey;
+    if (magic != cacheMagic || version != cacheVersion || storedKey != key)
+        return false;
+
+    // The body comes last, so the validators are read without it
+    in >> entry.etag >> entry.lastModified >> entry.fetched;
+    if (data)
+        in >> *data;
+
+    return in.status() == QDataStream::Ok;
+}
+
+void UpdaterCacheUtil::write(const QString& key, const UpdaterCacheEntry& entry, const QByteArray& data)
+{
+    const QString filePath = cacheFilePath(key);
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to write update cache:" << filePath;
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_8);
+    out << cacheMagic << cacheVersion << key
+        << entry.etag << entry.lastModified << entry.fetched << data;
+
+    if (!file.commit())
+        qWarning() << "Failed to write update cache:" << filePath;
+}
@@ -0,0 +1,83 @@
+#ifndef UPDATERCACHEUTIL_H
+#define UPDATERCACHEUTIL_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+struct UpdaterRelease;
+
+struct UpdaterCacheEntry {
+public:
+    QString etag = QString();
+    QString lastModified = QString();
+    QDateTime fetched = QDateTime();
+
+    bool isValid() const { return fetched.isValid(); }
+};
+
+class UpdaterCacheUtil
+{
+public:
+    UpdaterCacheUtil();
+
+    static const int freshSeconds;
+
+    /**
+     * @brief Gets the validators of a cached response, loading them from disk if needed.
+     * The body stays on disk, see readData(...)
+     * @param key Method and url of the request
+     * @param entry Filled with the cached validators on hit
+     * @return Bool indicating if a response is cached
+     */
+    static const bool lookup(const QString& key, UpdaterCacheEntry& entry);
+    /**
+     * @brief Reads the body of a cached response from disk
+     * @param key Method and url of the request
+     * @return Body of the response, empty if it is not cached
+     */
+    static const QByteArray readData(const QString& key);
+    /**
+     * @brief Checks if a cached response is recent enough to be used without revalidating
+     * @param entry Cached response
+     * @return Bool indicating if the response is fresh
+     */
+    static const bool isFresh(const UpdaterCacheEntry& entry);
+    /**
+     * @brief Stores the response of an update check on disk, only its validators are kept in memory
+     * @param key Method and url of the request
+     * @param entry Validators of the response, its releases are invalidated
+     * @param data Body of the response
+     */
+    static void store(const QString& key, const UpdaterCacheEntry& entry, const QByteArray& data);
+    /**
+     * @brief Marks a cached response as just revalidated, ie after a 304
+     * @param key Method and url of the request
+     */
+    static void touch(const QString& key);
+    /**
+     * @brief Gets the releases parsed from the cached response with the same settings
+     * @param key Method and url of the request
+     * @param settingsKey Fingerprint of the settings used to parse the response
+     * @param releases Filled with the parsed releases on hit
+     * @return Bool indicating if the parsed releases are cached
+     */
+    static const bool lookupReleases(const QString& key, const QString& settingsKey, QList<UpdaterRelease>& releases);
+    /**
+     * @brief Keeps the releases parsed from the cached response, in memory only
+     */
+    static void storeReleases(const QString& key, const QString& settingsKey, const QList<UpdaterRelease>& releases);
+
+private:
+    static QMutex m_mutex;
+    static QHash<QString, UpdaterCacheEntry> m_entries;
+
+    static const QString cacheFilePath(const QString& key);
+    static const bool read(const QString& key, UpdaterCacheEntry& entry, QByteArray* data);
+    static void write(const QString& key, const UpdaterCacheEntry& entry, const QByteArray& data);
+};
+
+#endif // UPDATERCACHEUTIL_H
@@ -1,6 +1,7 @@
 #include "updaterfactory.h"
 #include "jsonupdater.h"
 #include "staticupdater.h"
+#include "zsyncupdater.h"
 
 // ----------------- Public -----------------
 
@@ -15,6 +16,10 @@ IUpdater* UpdaterFactory::create(const QString &type, const UpdaterSettings &set
     {
         return new StaticUpdater(settings);
     }
+    else if (type == "zsync")
+    {
+        return new ZsyncUpdater(settings);
+    }
 
     return nullptr;
 }
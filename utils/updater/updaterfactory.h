@@ -6,6 +6,8 @@
 #include "managers/errormanager.h"
 #include "managers/settingsmanager.h"
 #include "utils/networkutil.h"
+#include "utils/updater/updatercacheutil.h"
+#include "utils/updater/updaterscheduler.h"
 
 #include <QObject>
 #include <QNetworkReply>
@@ -14,6 +16,7 @@
 #include <QString>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QTimer>
 
 struct UpdaterRelease {
 public:
@@ -70,12 +73,38 @@ public:
         m_settings = settings;
     }
 
+    void setPriority(UpdaterScheduler::Priority priority)
+    {
+        m_priority = priority;
+    }
+
     void fetchUpdatesAsync(const QString &url = QString())
     {
         QString targetUrl = url.isEmpty() ? m_settings.url : url;
+        const QString cacheKey = QString(m_headersOnly ? "HEAD " : "GET ") + targetUrl;
+
+        // Answer from the cache without a round trip while it is fresh
+        UpdaterCacheEntry cached;
+        const bool hasCached = UpdaterCacheUtil::lookup(cacheKey, cached);
+        if (hasCached && UpdaterCacheUtil::isFresh(cached)) {
+            QTimer::singleShot(0, this, [this, cacheKey, cached]() {
+                useCachedResponse(cacheKey);
+                emit updatesReady();
+            });
+            return;
+        }
+
         QNetworkRequest req((QUrl(targetUrl)));
         req.setHeader(QNetworkRequest::UserAgentHeader, "BarryAppLauncher");
 
+        // Revalidate a stale response, the server answers 304 without a body if it did not change
+        if (hasCached) {
+            if (!cached.etag.isEmpty())
+                req.setRawHeader("If-None-Match", cached.etag.toUtf8());
+            if (!cached.lastModified.isEmpty())
+                req.setRawHeader("If-Modified-Since", cached.lastModified.toUtf8());
+        }
+
         // Apply custom user update headers
         auto updateHeaders = SettingsManager::instance()->getUpdateHeaders();
         for (const auto &header : updateHeaders) {
@@ -87,20 +116,21 @@ public:
             }
         }
 
-        QNetworkReply *reply = nullptr;
-
-        if (m_headersOnly) {
-            // HEAD request = fetch headers only
-            reply = NetworkUtil::networkManager()->head(req);
-        } else {
-            // GET request = fetch full body
-            reply = NetworkUtil::networkManager()->get(req);
-        }
-
-        connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        // HEAD request = fetch headers only, GET request = fetch full body
+        // The scheduler paces the requests per host and honours rate limits
+        UpdaterScheduler::instance()->schedule(req, m_headersOnly, m_priority, this,
+                                               [this, cacheKey, hasCached, cached](QNetworkReply *reply) {
             int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
             QByteArray data;
 
+            if (status == 304 && hasCached) {
+                reply->deleteLater();
+                UpdaterCacheUtil::touch(cacheKey);
+                useCachedResponse(cacheKey);
+                emit updatesReady();
+                return;
+            }
+
             if (m_headersOnly) {
                 QJsonObject jsonHeaders;
 
@@ -122,8 +152,15 @@ public:
             reply->deleteLater();
 
             if (status >= 200 && status < 300) {
+                UpdaterCacheEntry entry;
+                entry.etag = QString::fromUtf8(reply->rawHeader("ETag"));
+                entry.lastModified = QString::fromUtf8(reply->rawHeader("Last-Modified"));
+                entry.fetched = QDateTime::currentDateTimeUtc();
+                UpdaterCacheUtil::store(cacheKey, entry, data);
+
                 // Success: parse JSON normally
                 parseData(data);
+                UpdaterCacheUtil::storeReleases(cacheKey, settingsKey(), m_releases);
             } else {
                 // Generic error handling
                 QString errorMsg = QString("Request failed with status %1").arg(status);
@@ -151,7 +188,30 @@ signals:
 protected:
     UpdaterSettings m_settings;
     bool m_headersOnly = false;
+    UpdaterScheduler::Priority m_priority = UpdaterScheduler::Normal;
     QList<UpdaterRelease> m_releases;
+
+    // Fingerprint of everything parseData depends on
+    QString settingsKey() const
+    {
+        QStringList parts = {
+            m_settings.type, m_settings.versionField, m_settings.versionPattern,
+            m_settings.downloadField, m_settings.downloadPattern, m_settings.dateField
+        };
+        for (const auto &filter : m_settings.filters)
+            parts << filter.field << filter.pattern;
+        return parts.join(QChar(0x1f));
+    }
+
+    void useCachedResponse(const QString &cacheKey)
+    {
+        if (UpdaterCacheUtil::lookupReleases(cacheKey, settingsKey(), m_releases))
+            return;
+
+        // Only the validators stay in memory, the body is read back when it has to be parsed
+        parseData(UpdaterCacheUtil::readData(cacheKey));
+        UpdaterCacheUtil::storeReleases(cacheKey, settingsKey(), m_releases);
+    }
 };
 
 class UpdaterFactory
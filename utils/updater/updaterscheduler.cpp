@@ -0,0 +1,276 @@
+#include "updaterscheduler.h"
+#include "managers/settingsmanager.h"
+#include "utils/networkutil.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <QNetworkAccessManager>
+#include <QTimeZone>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Stands in for a request that is not sent because its host is out of quota,
+// so callers handle it like the rate limited response the host would give
+class RateLimitedReply : public QNetworkReply
+{
+public:
+    RateLimitedReply(const QNetworkRequest& request, QNetworkAccessManager::Operation operation,
+                     qint64 resetMsecs, QObject* parent)
+        : QNetworkReply(parent)
+    {
+        const QString reset = QDateTime::fromMSecsSinceEpoch(resetMsecs).toString(Qt::ISODate);
+        m_data = QJsonDocument(QJsonObject{
+            { "message", "Rate limit exceeded until " + reset }
+        }).toJson(QJsonDocument::Compact);
+
+        setRequest(request);
+        setUrl(request.url());
+        setOperation(operation);
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 403);
+        setRawHeader("X-RateLimit-Remaining", "0");
+        setRawHeader("X-RateLimit-Reset", QByteArray::number(resetMsecs / 1000));
+        setError(QNetworkReply::ContentAccessDenied, "Rate limit exceeded");
+        open(QIODevice::ReadOnly);
+        setFinished(true);
+    }
+
+    void abort() override {}
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override { return m_data.size() - m_pos + QNetworkReply::bytesAvailable(); }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override
+    {
+        const qint64 size = std::min(maxSize, qint64(m_data.size()) - m_pos);
+        if (size <= 0)
+            return -1;
+
+        std::copy_n(m_data.constData() + m_pos, size, data);
+        m_pos += size;
+        return size;
+    }
+
+private:
+    QByteArray m_data;
+    qint64 m_pos = 0;
+};
+
+}
+
+// ----------------- Public -----------------
+
+UpdaterScheduler* UpdaterScheduler::instance()
+{
+    static UpdaterScheduler* singleton = new UpdaterScheduler();
+    return singleton;
+}
+
+void UpdaterScheduler::schedule(const QNetworkRequest& request, bool headersOnly, Priority priority,
+                                QObject* context, std::function<void(QNetworkReply*)> finishedCallback)
+{
+    Job job;
+    job.request = request;
+    job.headersOnly = headersOnly;
+    job.priority = priority;
+    job.context = context;
+    job.finishedCallback = finishedCallback;
+
+    enqueue(request.url().host(), job);
+    pump();
+}
+
+void UpdaterScheduler::schedulePost(const QNetworkRequest& request, const QByteArray& data, Priority priority,
+                                    QObject* context, std::function<void(QNetworkReply*)> finishedCallback)
+{
+    Job job;
+    job.request = request;
+    job.postData = data.isNull() ? QByteArray("") : data;
+    job.priority = priority;
+    job.context = context;
+    job.finishedCallback = finishedCallback;
+
+    enqueue(request.url().host(), job);
+    pump();
+}
+
+// ----------------- Private -----------------
+
+const double UpdaterScheduler::tokensPerSecond = 5.0;
+const double UpdaterScheduler::burstTokens = 10.0;
+const int UpdaterScheduler::maxRetries = 1;
+const qint64 UpdaterScheduler::maxPause = 60 * 1000;
+
+UpdaterScheduler::UpdaterScheduler(QObject* parent)
+    : QObject(parent)
+{
+    m_wakeTimer.setSingleShot(true);
+    connect(&m_wakeTimer, &QTimer::timeout, this, &UpdaterScheduler::pump);
+}
+
+void UpdaterScheduler::enqueue(const QString& host, const Job& job, bool front)
+{
+    auto it = m_hosts.find(host);
+    if (it == m_hosts.end()) {
+        Host state;
+        state.tokens = burstTokens;
+        state.refilled = QDateTime::currentMSecsSinceEpoch();
+        it = m_hosts.insert(host, state);
+    }
+
+    QList<Job>& queue = it->queue;
+
+    // Ordered by priority, first in first out within a priority
+    auto pos = front
+        ? std::find_if(queue.begin(), queue.end(), [&](const Job& other) { return other.priority <= job.priority; })
+        : std::find_if(queue.begin(), queue.end(), [&](const Job& other) { return other.priority < job.priority; });
+    queue.insert(pos, job);
+}
+
+void UpdaterScheduler::pump()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const int maxPerHost = std::max(1, SettingsManager::instance()->updateConcurrency());
+    qint64 wake = -1;
+    QList<QPair<Job, qint64>> rejected;
+
+    for (auto it = m_hosts.begin(); it != m_hosts.end(); ++it) {
+        Host& host = it.value();
+
+        // Out of quota for longer than is worth waiting, callers fall back right away
+        if (now < host.exhaustedUntil) {
+            for (const Job& job : std::as_const(host.queue))
+                rejected.append({ job, host.exhaustedUntil });
+            host.queue.clear();
+            continue;
+        }
+
+        host.tokens = std::min(burstTokens, host.tokens + (now - host.refilled) * tokensPerSecond / 1000.0);
+        host.refilled = now;
+
+        while (!host.queue.isEmpty() && host.running < maxPerHost
+               && now >= host.pausedUntil && host.tokens >= 1.0) {
+            Job job = host.queue.takeFirst();
+            if (!job.context)
+                continue;
+
+            host.tokens -= 1.0;
+            host.running++;
+            dispatch(it.key(), job);
+        }
+
+        if (host.queue.isEmpty() || host.running >= maxPerHost)
+            continue;
+
+        // Blocked on the pause or the bucket, come back when either clears
+        qint64 due = now >= host.pausedUntil
+            ? now + qint64(std::ceil((1.0 - host.tokens) * 1000.0 / tokensPerSecond))
+            : host.pausedUntil;
+        wake = wake < 0 ? due : std::min(wake, due);
+    }
+
+    if (wake >= 0)
+        m_wakeTimer.start(std::max<qint64>(0, wake - now));
+
+    // Queued, so a callback scheduling another request does not run inside this loop
+    for (const auto& [job, resetMsecs] : std::as_const(rejected)) {
+        if (!job.context)
+            continue;
+
+        const auto operation = !job.postData.isNull() ? QNetworkAccessManager::PostOperation
+                               : job.headersOnly ? QNetworkAccessManager::HeadOperation
+                                                 : QNetworkAccessManager::GetOperation;
+        auto* reply = new RateLimitedReply(job.request, operation, resetMsecs, this);
+        QMetaObject::invokeMethod(job.context, [job, reply]() {
+            job.finishedCallback(reply);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void UpdaterScheduler::dispatch(const QString& host, const Job& job)
+{
+    QNetworkReply* reply = nullptr;
+    if (!job.postData.isNull())
+        reply = NetworkUtil::networkManager()->post(job.request, job.postData);
+    else if (job.headersOnly)
+        reply = NetworkUtil::networkManager()->head(job.request);
+    else
+        reply = NetworkUtil::networkManager()->get(job.request);
+
+    connect(reply, &QNetworkReply::finished, this, [this, host, job, reply]() {
+        onFinished(host, job, reply);
+    });
+}
+
+void UpdaterScheduler::onFinished(const QString& host, const Job& job, QNetworkReply* reply)
+{
+    Host& state = m_hosts[host];
+    state.running--;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 until = pausedUntil(reply, now);
+
+    // Never hold the queue longer than maxPause, ie for an hour long GitHub reset,
+    // the host fails its requests until the reset instead
+    const bool exhausted = until - now > maxPause;
+    if (exhausted && until > state.exhaustedUntil) {
+        qWarning() << "Rate limit of" << host << "exhausted until"
+                   << QDateTime::fromMSecsSinceEpoch(until).toString(Qt::ISODate);
+        state.exhaustedUntil = until;
+    } else if (!exhausted && until > state.pausedUntil) {
+        state.pausedUntil = until;
+    }
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const bool rateLimited = status == 429 || (status == 403 && until > now);
+
+    if (rateLimited && !exhausted && job.retries < maxRetries && job.context) {
+        qInfo() << "Rate limited by" << host << "- retrying after" << (state.pausedUntil - now) << "ms";
+        reply->deleteLater();
+
+        Job retry = job;
+        retry.retries++;
+        enqueue(host, retry, true);
+    }
+    else if (job.context) {
+        job.finishedCallback(reply);
+    }
+    else {
+        reply->deleteLater();
+    }
+
+    pump();
+}
+
+const qint64 UpdaterScheduler::pausedUntil(QNetworkReply* reply, qint64 now)
+{
+    // Retry-After is either a delay in seconds or an http date
+    const QByteArray retryAfter = reply->rawHeader("Retry-After").trimmed();
+    if (!retryAfter.isEmpty()) {
+        bool ok = false;
+        const qint64 seconds = retryAfter.toLongLong(&ok);
+        if (ok)
+            return now + seconds * 1000;
+
+        const QDateTime date = QLocale::c().toDateTime(QString::fromLatin1(retryAfter), "ddd, dd MMM yyyy HH:mm:ss 'GMT'");
+        if (date.isValid())
+            return QDateTime(date.date(), date.time(), QTimeZone::UTC).toMSecsSinceEpoch();
+    }
+
+    // GitHub style, the reset is in epoch seconds
+    bool remainingOk = false;
+    const int remaining = reply->rawHeader("X-RateLimit-Remaining").toInt(&remainingOk);
+    if (remainingOk && remaining == 0) {
+        bool resetOk = false;
+        const qint64 reset = reply->rawHeader("X-RateLimit-Reset").toLongLong(&resetOk);
+        if (resetOk)
+            return reset * 1000;
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#ifndef UPDATERSCHEDULER_H
+#define UPDATERSCHEDULER_H
+
+#include <QHash>
+#include <QList>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+
+#include <functional>
+
+class UpdaterScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority {
+        Low,
+        Normal,
+        High
+    };
+
+    static UpdaterScheduler* instance();
+
+    /**
+     * @brief Queues an update check request. Requests are sent per host, at most
+     * updateConcurrency at a time and paced by a token bucket. A host that reports
+     * its rate limit is exhausted is paused until the limit resets, and the
+     * rejected request is retried once. If the reset is further away than maxPause,
+     * requests to the host fail right away until then instead of waiting.
+     * Higher priorities are sent first.
+     * @param request Request to send
+     * @param headersOnly Send a HEAD instead of a GET
+     * @param priority Priority of the request
+     * @param context Object owning the callback, the request is dropped if it is destroyed
+     * @param finishedCallback Method to get called with the finished reply, which it must delete
+     */
+    void schedule(const QNetworkRequest& request, bool headersOnly, Priority priority,
+                  QObject* context, std::function<void(QNetworkReply*)> finishedCallback);
+    /**
+     * @brief Queues a POST, ie a GraphQL query, with the same pacing as schedule
+     * @param request Request to send
+     * @param data Body of the request
+     * @param priority Priority of the request
+     * @param context Object owning the callback, the request is dropped if it is destroyed
+     * @param finishedCallback Method to get called with the finished reply, which it must delete
+     */
+    void schedulePost(const QNetworkRequest& request, const QByteArray& data, Priority priority,
+                      QObject* context, std::function<void(QNetworkReply*)> finishedCallback);
+
+private:
+    explicit UpdaterScheduler(QObject* parent = nullptr);
+
+    struct Job {
+        QNetworkRequest request;
+        bool headersOnly = false;
+        QByteArray postData;
+        Priority priority = Normal;
+        QPointer<QObject> context;
+        std::function<void(QNetworkReply*)> finishedCallback;
+        int retries = 0;
+    };
+
+    struct Host {
+        QList<Job> queue;
+        int running = 0;
+        double tokens = 0;
+        qint64 refilled = 0;
+        qint64 pausedUntil = 0;
+        qint64 exhaustedUntil = 0;
+    };
+
+    static const double tokensPerSecond;
+    static const double burstTokens;
+    static const int maxRetries;
+    static const qint64 maxPause;
+
+    QHash<QString, Host> m_hosts;
+    QTimer m_wakeTimer;
+
+    void enqueue(const QString& host, const Job& job, bool front = false);
+    void pump();
+    void dispatch(const QString& host, const Job& job);
+    void onFinished(const QString& host, const Job& job, QNetworkReply* reply);
+
+    static const qint64 pausedUntil(QNetworkReply* reply, qint64 now);
+
+    Q_DISABLE_COPY(UpdaterScheduler);
+};
+
+#endif // UPDATERSCHEDULER_H
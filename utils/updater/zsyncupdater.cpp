@@ -0,0 +1,63 @@
+#include "zsyncupdater.h"
+#include "managers/errormanager.h"
+#include "utils/jsonutil.h"
+#include "utils/regexutil.h"
+#include "utils/zsyncutil.h"
+
+#include <QRegularExpression>
+
+ZsyncUpdater::ZsyncUpdater(QObject *parent) : IUpdater(parent) {}
+ZsyncUpdater::ZsyncUpdater(const UpdaterSettings &settings, QObject *parent) : IUpdater(settings, parent) {}
+
+void ZsyncUpdater::parseData(const QByteArray &data)
+{
+    m_releases.clear();
+
+    ZsyncControl control;
+    if (!ZsyncUtil::parseControl(data, QUrl(m_settings.url), control)) {
+        ErrorManager::instance()->reportError("Invalid or unsupported zsync file: " + m_settings.url);
+        return;
+    }
+
+    const QRegularExpression versionRe = RegexUtil::get(m_settings.versionPattern);
+    if (!versionRe.isValid()) {
+        ErrorManager::instance()->reportError("Invalid version regex: " + m_settings.versionPattern);
+
+    }
+
+    // Control file headers are exposed like json fields, ie "Filename" or "MTime"
+    const QJsonObject obj = control.headers;
+
+    // Extract version
+    QString version;
+    {
+        const QString versionField = m_settings.versionField.isEmpty() ? "Filename" : m_settings.versionField;
+        QList<QJsonValue> vals = JsonUtil::getValuesByPath(obj, versionField);
+        if (!vals.isEmpty())
+        {
+            version = vals.first().toVariant().toString();
+            if (!versionRe.pattern().isEmpty()) {
+                QRegularExpressionMatch match = versionRe.match(version);
+                if (match.hasMatch()) {
+                    version = match.captured(1).isEmpty() ? match.captured(0) : match.captured(1);
+                }
+            }
+        }
+    }
+
+    // Extract date
+    QString date;
+    {
+        const QString dateField = m_settings.dateField.isEmpty() ? "MTime" : m_settings.dateField;
+        QList<QJsonValue> vals = JsonUtil::getValuesByPath(obj, dateField);
+        if (!vals.isEmpty())
+            date = vals.first().toVariant().toString();
+    }
+
+    // The control file is the download, the update itself fetches only the changed blocks
+    UpdaterRelease r;
+    r.version  = version;
+    r.date     = date;
+    r.download = m_settings.url;
+    m_releases.append(r);
+}
@@ -0,0 +1,19 @@
+#ifndef ZSYNCUPDATER_H
+#define ZSYNCUPDATER_H
+
+#include "utils/updater/updaterfactory.h"
+
+#include <QList>
+#include <QString>
+
+class ZsyncUpdater : public IUpdater
+{
+    Q_OBJECT
+public:
+    explicit ZsyncUpdater(QObject *parent = nullptr);
+    explicit ZsyncUpdater(const UpdaterSettings &settings, QObject *parent = nullptr);
+
+    void parseData(const QByteArray &data) override;
+};
+
+#endif // ZSYNCUPDATER_H
@@ -1,6 +1,8 @@
 #ifndef VERSIONUTIL_H
 #define VERSIONUTIL_H
 
+#include "utils/regexutil.h"
+
 #include <QDate>
 #include <QString>
 #include <QVersionNumber>
@@ -48,7 +50,7 @@ public:
         }
 
         // try date
-        QRegularExpression dateRe(R"((\d{4})-(\d{2})-(\d{2}))");
+        static const QRegularExpression dateRe = RegexUtil::get(R"((\d{4})-(\d{2})-(\d{2}))");
         QRegularExpressionMatch dm = dateRe.match(cleaned);
 
         if (dm.hasMatch()) {
@@ -63,7 +65,7 @@ public:
         }
 
         // try commit hash
-        QRegularExpression hashRe(R"(\b[0-9a-fA-F]{7,}\b)");
+        static const QRegularExpression hashRe = RegexUtil::get(R"(\b[0-9a-fA-F]{7,}\b)");
         if (hashRe.match(cleaned).hasMatch()) {
             v.commitHash = cleaned;
         }
@@ -73,39 +75,7 @@ public:
 
     // Compare version strings
     // Returns -1 if v1 < v2, 0 if equal, 1 if v1 > v2
-    static int compareVersions(const QString &v1, const QString &v2) {
-        Version a = parseVersion(v1);
-        Version b = parseVersion(v2);
-        int result = 0;
-
-        if(a.hasSemVer() && b.hasSemVer())
-        {
-            result = compareSemVer(a.semver, b.semver);
-        }
-
-        if(result == 0)
-        {
-            if(a.hasDate() && b.hasDate())
-            {
-                result = a.date < b.date ? -1 : (a.date > b.date ? 1 : 0);
-            }
-
-            if(result == 0)
-            {
-                if(a.hasCommit() && b.hasCommit())
-                {
-                    result = QString::compare(a.commitHash, b.commitHash, Qt::CaseInsensitive);
-                }
-
-                if(result == 0)
-                {
-                    result = QString::compare(a.raw, b.raw, Qt::CaseInsensitive) != 0 ? 1 : 0;
-                }
-            }
-        }
-
-        return result;
-    }
+    static int compareVersions(const QString &v1, const QString &v2);
 
 private:
     // Parse a semantic version string
@@ -114,10 +84,11 @@ private:
         QString cleaned = input.trimmed();
 
         // Strip leading non-digits (e.g., "v1.2.3")
-        cleaned.remove(QRegularExpression("^[^0-9]+"));
+        static const QRegularExpression prefixRe = RegexUtil::get("^[^0-9]+");
+        cleaned.remove(prefixRe);
 
         // Regex: numeric version + optional prerelease + optional build metadata
-        QRegularExpression re(R"(^(\d+(?:\.\d+)*)(?:-([0-9A-Za-z\.-]+))?(?:\+([0-9A-Za-z\.-]+))?$)");
+        static const QRegularExpression re = RegexUtil::get(R"(^(\d+(?:\.\d+)*)(?:-([0-9A-Za-z\.-]+))?(?:\+([0-9A-Za-z\.-]+))?$)");
         QRegularExpressionMatch m = re.match(cleaned);
 
         if (m.hasMatch()) {
@@ -128,30 +99,89 @@ private:
 
         return sv;
     }
+};
 
-    // Compare two SemVer structs
-    // Returns -1 if a < b, 0 if equal, 1 if a > b
-    static int compareSemVer(const SemVer &a, const SemVer &b) {
-        int cmp = QVersionNumber::compare(a.version, b.version);
-        if (cmp != 0) return cmp;
+/**
+ * @brief Version string parsed once, so it can be compared against many others
+ * without going through the regexes again
+ */
+class VersionKey
+{
+public:
+    VersionKey() = default;
 
-        // Handle pre-release comparison
-        if (a.prerelease.isEmpty() && b.prerelease.isEmpty()) return 0;
-        if (a.prerelease.isEmpty()) return 1;   // release > pre-release
-        if (b.prerelease.isEmpty()) return -1;  // pre-release < release
+    explicit VersionKey(const QString &input) {
+        const Version v = VersionUtil::parseVersion(input);
 
-        return comparePreRelease(a.prerelease, b.prerelease);
+        m_version = v.semver.version;
+        m_prerelease = v.semver.prerelease.toCaseFolded();
+        m_prereleaseNumber = v.semver.prerelease.toInt(&m_prereleaseIsNumber);
+        m_date = v.date;
+        m_commitHash = v.commitHash.toCaseFolded();
+        m_raw = v.raw.toCaseFolded();
     }
 
-    // Numeric-aware pre-release comparison
-    static int comparePreRelease(const QString &a, const QString &b) {
-        bool ok1, ok2;
-        int num1 = a.toInt(&ok1);
-        int num2 = b.toInt(&ok2);
+    bool isEmpty() const { return m_raw.isEmpty(); }
+
+    /**
+     * @brief Compares two keys with the same rules as VersionUtil::compareVersions
+     * @param other Key to compare against
+     * @return -1 if older, 0 if equal, 1 if newer or not comparable but different
+     */
+    int compare(const VersionKey &other) const {
+        int result = compareParsed(other);
+        if (result == 0 && m_raw != other.m_raw)
+            result = 1;
+        return result;
+    }
+
+    bool operator==(const VersionKey &other) const { return compare(other) == 0; }
+
+private:
+    QVersionNumber m_version;
+    QString m_prerelease;
+    int m_prereleaseNumber = 0;
+    bool m_prereleaseIsNumber = false;
+    QDate m_date;
+    QString m_commitHash;
+    QString m_raw;
+
+    // Semver, then date, then commit hash, each only when both sides have it
+    int compareParsed(const VersionKey &other) const {
+        int result = 0;
+
+        if (!m_version.isNull() && !other.m_version.isNull())
+            result = compareSemVer(other);
+
+        if (result == 0 && m_date.isValid() && other.m_date.isValid())
+            result = m_date < other.m_date ? -1 : (m_date > other.m_date ? 1 : 0);
 
-        if (ok1 && ok2) return (num1 < num2) ? -1 : (num1 > num2 ? 1 : 0);
-        return QString::compare(a, b, Qt::CaseInsensitive);
+        if (result == 0 && !m_commitHash.isEmpty() && !other.m_commitHash.isEmpty())
+            result = sign(m_commitHash.compare(other.m_commitHash));
+
+        return result;
+    }
+
+    int compareSemVer(const VersionKey &other) const {
+        int cmp = QVersionNumber::compare(m_version, other.m_version);
+        if (cmp != 0) return sign(cmp);
+
+        // Handle pre-release comparison
+        if (m_prerelease.isEmpty() && other.m_prerelease.isEmpty()) return 0;
+        if (m_prerelease.isEmpty()) return 1;         // release > pre-release
+        if (other.m_prerelease.isEmpty()) return -1;  // pre-release < release
+
+        // Numeric-aware pre-release comparison
+        if (m_prereleaseIsNumber && other.m_prereleaseIsNumber)
+            return m_prereleaseNumber < other.m_prereleaseNumber ? -1 : (m_prereleaseNumber > other.m_prereleaseNumber ? 1 : 0);
+        return sign(m_prerelease.compare(other.m_prerelease));
     }
+
+    static int sign(int value) { return (value > 0) - (value < 0); }
 };
 
+inline int VersionUtil::compareVersions(const QString &v1, const QString &v2) {
+    return VersionKey(v1).compare(VersionKey(v2));
+}
+
 #endif // VERSIONUTIL_H
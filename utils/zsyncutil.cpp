@@ -0,0 +1,601 @@
+#include "zsyncutil.h"
+#include "managers/errormanager.h"
+#include "utils/downloadutil.h"
+#include "utils/networkutil.h"
+
+#include <QBitArray>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QNetworkRequest>
+#include <QRegularExpression>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <cstring>
+
+namespace {
+
+quint64 readLittleEndian(const QByteArray& bytes, qsizetype offset, int length)
+{
+    if (offset < 0 || offset + length > bytes.size())
+        return 0;
+
+    quint64 value = 0;
+    for (int i = length - 1; i >= 0; --i)
+        value = (value << 8) | static_cast<quint8>(bytes.at(offset + i));
+    return value;
+}
+
+}
+
+// ----------------- Public -----------------
+
+const bool ZsyncUtil::parseControl(const QByteArray& data, const QUrl& controlUrl, ZsyncControl& control)
+{
+    // Header lines are terminated by an empty line, followed by the binary block sums
+    const qsizetype headerEnd = data.indexOf("\n\n");
+    if (headerEnd < 0)
+        return false;
+
+    const QList<QByteArray> lines = data.left(headerEnd).split('\n');
+    for (const QByteArray& line : lines) {
+        const qsizetype separator = line.indexOf(':');
+        if (separator <= 0)
+            continue;
+
+        const QString key = QString::fromUtf8(line.left(separator)).trimmed();
+        const QString value = QString::fromUtf8(line.mid(separator + 1)).trimmed();
+        control.headers.insert(key, value);
+
+        if (key == "Filename") {
+            control.filename = value;
+        } else if (key == "URL" && control.url.isEmpty()) {
+            control.url = controlUrl.resolved(QUrl(value));
+        } else if (key == "Length") {
+            control.length = value.toLongLong();
+        } else if (key == "Blocksize") {
+            control.blockSize = value.toInt();
+        } else if (key == "Hash-Lengths") {
+            const QStringList parts = value.split(',');
+            if (parts.size() == 3) {
+                control.seqMatches = parts.at(0).toInt();
+                control.rsumBytes = parts.at(1).toInt();
+                control.checksumBytes = parts.at(2).toInt();
+            }
+        } else if (key == "SHA-1") {
+            control.sha1 = QByteArray::fromHex(value.toLatin1());
+        }
+    }
+
+    if (control.length <= 0 || control.blockSize <= 0 || (control.blockSize & (control.blockSize - 1)) != 0
+        || control.seqMatches < 1 || control.seqMatches > 2
+        || control.rsumBytes < 1 || control.rsumBytes > 4
+        || control.checksumBytes < 1 || control.checksumBytes > 16
+        || !control.url.isValid() || control.sha1.size() != 20) {
+        return false;
+    }
+
+    const qsizetype sumsSize = static_cast<qsizetype>(control.blockCount()) * (control.rsumBytes + control.checksumBytes);
+    control.blockSums = data.mid(headerEnd + 2, sumsSize);
+
+    return control.blockSums.size() == sumsSize;
+}
+
+const QString ZsyncUtil::readUpdateInformation(const QString& appImagePath)
+{
+    QFile file(appImagePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+
+    const QByteArray header = file.read(64);
+    if (header.size() < 52 || !header.startsWith("\x7f" "ELF") || header.at(5) != 1)
+        return QString();
+
+    const bool is64 = header.at(4) == 2;
+    const quint64 sectionHeaderOffset = is64 ? readLittleEndian(header, 0x28, 8) : readLittleEndian(header, 0x20, 4);
+    const quint64 sectionHeaderSize = readLittleEndian(header, is64 ? 0x3A : 0x2E, 2);
+    const quint64 sectionCount = readLittleEndian(header, is64 ? 0x3C : 0x30, 2);
+    const quint64 namesIndex = readLittleEndian(header, is64 ? 0x3E : 0x32, 2);
+
+    if (sectionCount == 0 || sectionCount > 4096 || namesIndex >= sectionCount
+        || sectionHeaderSize < (is64 ? 64u : 40u) || !file.seek(sectionHeaderOffset)) {
+        return QString();
+    }
+
+    const QByteArray sections = file.read(sectionHeaderSize * sectionCount);
+    if (sections.size() < static_cast<qsizetype>(sectionHeaderSize * sectionCount))
+        return QString();
+
+    auto sectionName = [&](quint64 i) { return readLittleEndian(sections, i * sectionHeaderSize, 4); };
+    auto sectionOffset = [&](quint64 i) { return readLittleEndian(sections, i * sectionHeaderSize + (is64 ? 24 : 16), is64 ? 8 : 4); };
+    auto sectionSize = [&](quint64 i) { return readLittleEndian(sections, i * sectionHeaderSize + (is64 ? 32 : 20), is64 ? 8 : 4); };
+
+    if (!file.seek(sectionOffset(namesIndex)))
+        return QString();
+    const QByteArray names = file.read(qMin<quint64>(sectionSize(namesIndex), 64 * 1024));
+
+    for (quint64 i = 0; i < sectionCount; ++i) {
+        const quint64 nameOffset = sectionName(i);
+        if (nameOffset >= static_cast<quint64>(names.size()))
+            continue;
+
+        if (qstrcmp(names.constData() + nameOffset, ".upd_info") != 0)
+            continue;
+
+        if (!file.seek(sectionOffset(i)))
+            return QString();
+
+        QByteArray info = file.read(qMin<quint64>(sectionSize(i), 4096));
+        const qsizetype terminator = info.indexOf('\0');
+        if (terminator >= 0)
+            info.truncate(terminator);
+        return QString::fromUtf8(info).trimmed();
+    }
+
+    return QString();
+}
+
+void ZsyncUtil::download(const QUrl& controlUrl, const QString& seedPath, const QString& filePath,
+                         std::function<void(bool)> finishedCallback,
+                         std::function<void(qint64, qint64)> progressCallback)
+{
+    auto* download = new ZsyncUtil(controlUrl, seedPath, filePath, finishedCallback, progressCallback);
+    download->start();
+}
+
+// ----------------- Private -----------------
+
+// Bounds the memory used by a single multi-range reply
+const int ZsyncUtil::maxRangesPerRequest = 32;
+const qint64 ZsyncUtil::maxBytesPerRequest = 8 * 1024 * 1024;
+
+ZsyncUtil::ZsyncUtil(const QUrl& controlUrl, const QString& seedPath, const QString& filePath,
+                     std::function<void(bool)> finishedCallback,
+                     std::function<void(qint64, qint64)> progressCallback,
+                     QObject* parent)
+    : QObject(parent)
+    , m_controlUrl(controlUrl)
+    , m_seedPath(seedPath)
+    , m_filePath(filePath)
+    , m_finishedCallback(finishedCallback)
+    , m_progressCallback(progressCallback)
+{}
+
+void ZsyncUtil::start()
+{
+    QNetworkRequest request(m_controlUrl);
+    request.setHeader(QNetworkRequest::UserAgentHeader, "BarryAppLauncher");
+
+    QNetworkReply* reply = NetworkUtil::networkManager()->get(request);
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        onControlFinished(reply);
+    });
+}
+
+void ZsyncUtil::onControlFinished(QNetworkReply* reply)
+{
+    reply->deleteLater();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        ErrorManager::instance()->reportError("Failed to download zsync file: " + reply->errorString());
+        finish(false);
+        return;
+    }
+
+    if (!parseControl(reply->readAll(), reply->url(), m_control)) {
+        ErrorManager::instance()->reportError("Invalid or unsupported zsync file: " + m_controlUrl.toString());
+        finish(false);
+        return;
+    }
+
+    // Matching reads the whole seed file, keep it off the UI thread
+    const ZsyncControl control = m_control;
+    const QString seedPath = m_seedPath;
+    const QString filePath = m_filePath;
+    QtConcurrent::run([control, seedPath, filePath]() {
+        qint64 reused = 0;
+        return matchBlocks(control, seedPath, filePath, reused);
+    }).then(this, [this](const QList<Range>& missing) {
+        onMatchFinished(missing);
+    });
+}
+
+void ZsyncUtil::onMatchFinished(const QList<Range>& missing)
+{
+    m_missing = missing;
+
+    qint64 missingBytes = 0;
+    for (const Range& range : m_missing)
+        missingBytes += range.second - range.first + 1;
+    m_reused = m_control.length - missingBytes;
+
+    // Nothing to reuse, a plain (resumable) download is cheaper than ranges
+    if (m_reused <= 0) {
+        fallback();
+        return;
+    }
+
+    reportProgress();
+    fetchNextRanges();
+}
+
+void ZsyncUtil::fetchNextRanges()
+{
+    if (m_missing.isEmpty()) {
+        verify();
+        return;
+    }
+
+    // Take as many ranges as fit in one request, splitting a range that is too large
+    QList<Range> ranges;
+    qint64 bytes = 0;
+    while (!m_missing.isEmpty() && ranges.size() < maxRangesPerRequest && bytes < maxBytesPerRequest) {
+        Range& range = m_missing.first();
+        const qint64 length = range.second - range.first + 1;
+        const qint64 take = qMin(length, maxBytesPerRequest - bytes);
+
+        ranges.append({ range.first, range.first + take - 1 });
+        bytes += take;
+
+        if (take == length)
+            m_missing.removeFirst();
+        else
+            range.first += take;
+    }
+
+    QStringList rangeSpecs;
+    for (const Range& range : ranges)
+        rangeSpecs.append(QString("%1-%2").arg(range.first).arg(range.second));
+
+    QNetworkRequest request(m_control.url);
+    request.setHeader(QNetworkRequest::UserAgentHeader, "BarryAppLauncher");
+    request.setRawHeader("Range", "bytes=" + rangeSpecs.join(',').toLatin1());
+
+    QNetworkReply* reply = NetworkUtil::networkManager()->get(request);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, ranges]() {
+        onRangesFinished(reply, ranges);
+    });
+
+    // A server ignoring the ranges sends the whole file, stop before it is buffered
+    connect(reply, &QNetworkReply::metaDataChanged, this, [this, reply]() {
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status < 200 || status >= 300 || status == 206)
+            return;
+
+        qWarning() << "Server ignored range request (" << status << "), falling back to full download";
+        disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+        reply->deleteLater();
+        fallback();
+    });
+}
+
+void ZsyncUtil::onRangesFinished(QNetworkReply* reply, const QList<Range>& ranges)
+{
+    reply->deleteLater();
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() != QNetworkReply::NoError || status != 206) {
+        // Server ignored the ranges or failed, get the whole file instead
+        qWarning() << "Range request failed (" << status << "), falling back to full download:" << reply->errorString();
+        fallback();
+        return;
+    }
+
+    if (!writeRanges(reply, reply->readAll(), ranges, m_filePath)) {
+        qWarning() << "Unexpected range response, falling back to full download";
+        fallback();
+        return;
+    }
+
+    for (const Range& range : ranges)
+        m_downloaded += range.second - range.first + 1;
+
+    reportProgress();
+    fetchNextRanges();
+}
+
+void ZsyncUtil::verify()
+{
+    const ZsyncControl control = m_control;
+    const QString filePath = m_filePath;
+    QtConcurrent::run([control, filePath]() {
+        return verifyFile(control, filePath);
+    }).then(this, [this](bool verified) {
+        if (!verified) {
+            qWarning() << "Delta update checksum mismatch, falling back to full download";
+            fallback();
+            return;
+        }
+
+        qInfo().noquote() << QString("Delta update of %1: reused %2 bytes, downloaded %3 bytes, saved %4%")
+                                 .arg(m_control.filename)
+                                 .arg(m_reused)
+                                 .arg(m_downloaded)
+                                 .arg(m_control.length > 0 ? m_reused * 100 / m_control.length : 0);
+        finish(true);
+    });
+}
+
+void ZsyncUtil::fallback()
+{
+    QFile::remove(m_filePath);
+    m_fellBack = true;
+
+    DownloadUtil::download(m_control.url, m_filePath,
+                           [this](bool success) { finish(success); },
+                           m_progressCallback);
+}
+
+void ZsyncUtil::finish(bool success)
+{
+    // After a fallback the file belongs to DownloadUtil, which may keep it to resume
+    if (!success && !m_fellBack)
+        QFile::remove(m_filePath);
+
+    if (m_finishedCallback)
+        m_finishedCallback(success);
+
+    deleteLater();
+}
+
+void ZsyncUtil::reportProgress()
+{
+    if (m_progressCallback)
+        m_progressCallback(m_reused + m_downloaded, m_control.length);
+}
+
+const QList<ZsyncUtil::Range> ZsyncUtil::matchBlocks(const ZsyncControl& control, const QString& seedPath, const QString& filePath, qint64& reused)
+{
+    const int blockCount = control.blockCount();
+    const qint64 blockSize = control.blockSize;
+    const int seq = control.seqMatches;
+    const int entrySize = control.rsumBytes + control.checksumBytes;
+    const uchar* sums = reinterpret_cast<const uchar*>(control.blockSums.constData());
+
+    // Only the trailing rsumBytes of the big endian (a, b) pair are stored
+    const quint16 aMask = control.rsumBytes >= 4 ? 0xffff : (control.rsumBytes == 3 ? 0xff : 0);
+    const quint16 bMask = control.rsumBytes >= 2 ? 0xffff : 0xff;
+    int blockShift = 0;
+    while ((qint64(1) << blockShift) < blockSize)
+        ++blockShift;
+
+    QList<quint16> blockA(blockCount);
+    QList<quint16> blockB(blockCount);
+    for (int i = 0; i < blockCount; ++i) {
+        const uchar* entry = sums + qsizetype(i) * entrySize;
+        quint32 value = 0;
+        for (int j = 0; j < control.rsumBytes; ++j)
+            value = (value << 8) | entry[j];
+        blockA[i] = (value >> 16) & aMask;
+        blockB[i] = value & bMask;
+    }
+
+    // With seq matches the key covers this block and the next one, like zsync does
+    auto makeKey = [seq](quint16 a0, quint16 b0, quint16 b1) -> quint32 {
+        return seq > 1 ? (quint32(b0) << 16) | b1 : (quint32(a0) << 16) | b0;
+    };
+    auto filterIndex = [](quint32 key) -> qsizetype {
+        return (key ^ (key >> 20)) & 0xFFFFF;
+    };
+
+    QHash<quint32, QList<int>> table;
+    QBitArray filter(0x100000);
+    for (int i = 0; i + seq - 1 < blockCount; ++i) {
+        const quint32 key = makeKey(blockA[i], blockB[i], seq > 1 ? blockB[i + 1] : 0);
+        table[key].append(i);
+        filter.setBit(filterIndex(key));
+    }
+
+    QFile out(filePath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate) || !out.resize(control.length))
+        return { { 0, control.length - 1 } };
+
+    QList<bool> present(blockCount, false);
+    reused = 0;
+
+    QFile seed(seedPath);
+    const qint64 seedSize = seed.size();
+    const qint64 windowSize = blockSize * seq;
+    const uchar* data = nullptr;
+    if (seedSize >= windowSize && seed.open(QIODevice::ReadOnly))
+        data = seed.map(0, seedSize);
+
+    auto writeBlock = [&](int block, const uchar* source) {
+        if (present[block])
+            return;
+        const qint64 offset = block * blockSize;
+        const qint64 length = qMin(blockSize, control.length - offset);
+        if (out.seek(offset) && out.write(reinterpret_cast<const char*>(source), length) == length) {
+            present[block] = true;
+            reused += length;
+        }
+    };
+
+    auto calcRsum = [&](qint64 offset, quint16& a, quint16& b) {
+        a = 0;
+        b = 0;
+        qint64 weight = blockSize;
+        for (qint64 k = 0; k < blockSize; ++k, --weight) {
+            const uchar c = data[offset + k];
+            a += c;
+            b += static_cast<quint16>(weight * c);
+        }
+    };
+
+    auto checksum = [&](qint64 offset) {
+        return QCryptographicHash::hash(QByteArrayView(data + offset, blockSize), QCryptographicHash::Md4);
+    };
+
+    if (data) {
+        quint16 a0 = 0, b0 = 0, a1 = 0, b1 = 0;
+        bool recalc = true;
+        qint64 p = 0;
+
+        while (p + windowSize <= seedSize) {
+            if (recalc) {
+                calcRsum(p, a0, b0);
+                if (seq > 1)
+                    calcRsum(p + blockSize, a1, b1);
+                recalc = false;
+            }
+
+            const quint32 key = makeKey(a0 & aMask, b0 & bMask, b1 & bMask);
+            bool matched = false;
+
+            if (filter.testBit(filterIndex(key))) {
+                auto it = table.constFind(key);
+                if (it != table.constEnd()) {
+                    QByteArray sum0;
+                    QByteArray sum1;
+                    for (int block : *it) {
+                        if ((a0 & aMask) != blockA[block] || (seq > 1 && (a1 & aMask) != blockA[block + 1]))
+                            continue;
+
+                        if (sum0.isEmpty())
+                            sum0 = checksum(p);
+                        if (std::memcmp(sum0.constData(), sums + qsizetype(block) * entrySize + control.rsumBytes, control.checksumBytes) != 0)
+                            continue;
+
+                        if (seq > 1) {
+                            if (sum1.isEmpty())
+                                sum1 = checksum(p + blockSize);
+                            if (std::memcmp(sum1.constData(), sums + qsizetype(block + 1) * entrySize + control.rsumBytes, control.checksumBytes) != 0)
+                                continue;
+                        }
+
+                        for (int k = 0; k < seq; ++k)
+                            writeBlock(block + k, data + p + k * blockSize);
+                        matched = true;
+                    }
+                }
+            }
+
+            // Jump over matched data, most files share long runs of blocks
+            if (matched) {
+                p += blockSize;
+                recalc = true;
+                continue;
+            }
+
+            if (p + windowSize >= seedSize)
+                break;
+
+            const uchar old0 = data[p];
+            const uchar new0 = data[p + blockSize];
+            a0 += new0 - old0;
+            b0 += a0 - (old0 << blockShift);
+
+            if (seq > 1) {
+                const uchar old1 = data[p + blockSize];
+                const uchar new1 = data[p + 2 * blockSize];
+                a1 += new1 - old1;
+                b1 += a1 - (old1 << blockShift);
+            }
+
+            ++p;
+        }
+
+        seed.unmap(const_cast<uchar*>(data));
+    }
+
+    out.close();
+
+    // Merge consecutive missing blocks into byte ranges
+    QList<Range> missing;
+    for (int i = 0; i < blockCount; ++i) {
+        if (present[i])
+            continue;
+
+        const qint64 start = i * blockSize;
+        const qint64 end = qMin((i + 1) * blockSize, control.length) - 1;
+        if (!missing.isEmpty() && missing.last().second + 1 == start)
+            missing.last().second = end;
+        else
+            missing.append({ start, end });
+    }
+
+    return missing;
+}
+
+const bool ZsyncUtil::writeRanges(QNetworkReply* reply, const QByteArray& body, const QList<Range>& ranges, const QString& filePath)
+{
+    QFile out(filePath);
+    if (!out.open(QIODevice::ReadWrite))
+        return false;
+
+    static const QRegularExpression contentRangeRe(R"(bytes\s+(\d+)-(\d+))", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression boundaryRe(R"(boundary="?([^";]+)"?)", QRegularExpression::CaseInsensitiveOption);
+
+    qint64 requested = 0;
+    for (const Range& range : ranges)
+        requested += range.second - range.first + 1;
+
+    qint64 written = 0;
+    auto writePart = [&](const QString& contentRange, const char* partData, qint64 available) {
+        QRegularExpressionMatch match = contentRangeRe.match(contentRange);
+        if (!match.hasMatch())
+            return false;
+
+        const qint64 start = match.captured(1).toLongLong();
+        const qint64 length = match.captured(2).toLongLong() - start + 1;
+        if (length <= 0 || length > available || !out.seek(start) || out.write(partData, length) != length)
+            return false;
+
+        written += length;
+        return true;
+    };
+
+    const QString contentType = reply->header(QNetworkRequest::ContentTypeHeader).toString();
+    QRegularExpressionMatch boundaryMatch = boundaryRe.match(contentType);
+
+    if (!contentType.startsWith("multipart/byteranges", Qt::CaseInsensitive) || !boundaryMatch.hasMatch()) {
+        // Single range reply
+        if (!writePart(QString::fromLatin1(reply->rawHeader("Content-Range")), body.constData(), body.size()))
+            return false;
+        return written >= requested;
+    }
+
+    // Walk the parts by their Content-Range lengths rather than searching for the boundary in the data
+    const QByteArray delimiter = "--" + boundaryMatch.captured(1).toLatin1();
+    qsizetype pos = 0;
+    while ((pos = body.indexOf(delimiter, pos)) >= 0) {
+        pos += delimiter.size();
+        if (body.mid(pos, 2) == "--")
+            break;
+
+        const qsizetype headersEnd = body.indexOf("\r\n\r\n", pos);
+        if (headersEnd < 0)
+            return false;
+
+        QString contentRange;
+        const QList<QByteArray> headers = body.mid(pos, headersEnd - pos).split('\n');
+        for (const QByteArray& header : headers) {
+            if (header.trimmed().toLower().startsWith("content-range:"))
+                contentRange = QString::fromLatin1(header.mid(header.indexOf(':') + 1)).trimmed();
+        }
+
+        const qsizetype dataStart = headersEnd + 4;
+        const qint64 before = written;
+        if (!writePart(contentRange, body.constData() + dataStart, body.size() - dataStart))
+            return false;
+
+        pos = dataStart + (written - before);
+    }
+
+    return written >= requested;
+}
+
+const bool ZsyncUtil::verifyFile(const ZsyncControl& control, const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly) || file.size() != control.length)
+        return false;
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file))
+        return false;
+
+    return hash.result() == control.sha1;
+}
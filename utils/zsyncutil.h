@@ -0,0 +1,102 @@
+#ifndef ZSYNCUTIL_H
+#define ZSYNCUTIL_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QNetworkReply>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QUrl>
+
+#include <functional>
+
+struct ZsyncControl {
+public:
+    QJsonObject headers { };
+    QString filename = QString();
+    QUrl url = QUrl();
+    qint64 length = 0;
+    int blockSize = 0;
+    int seqMatches = 1;
+    int rsumBytes = 4;
+    int checksumBytes = 16;
+    QByteArray sha1 = QByteArray();
+    QByteArray blockSums = QByteArray();
+
+    int blockCount() const { return blockSize > 0 ? static_cast<int>((length + blockSize - 1) / blockSize) : 0; }
+};
+
+class ZsyncUtil : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Parses a zsync control file
+     * @param data Contents of the control file
+     * @param controlUrl Url of the control file, used to resolve a relative target url
+     * @param control Parsed control file
+     * @return Bool indicating if parse successful
+     */
+    static const bool parseControl(const QByteArray& data, const QUrl& controlUrl, ZsyncControl& control);
+    /**
+     * @brief Reads the update information embedded in the appimage's .upd_info section
+     * @param appImagePath Path to the appimage
+     * @return Update information, ie "zsync|https://...", or empty if none
+     */
+    static const QString readUpdateInformation(const QString& appImagePath);
+    /**
+     * @brief Builds filePath from the zsync control file at controlUrl, reusing every block
+     * already present in seedPath and fetching only the missing ones with range requests.
+     * Falls back to a full download if the server does not support ranges or the result
+     * does not verify. Must be called from the thread owning NetworkUtil::networkManager().
+     * @param controlUrl Url of the zsync control file
+     * @param seedPath Path of the local file to reuse blocks from, ie the current appimage
+     * @param filePath Path of the file to write
+     * @param finishedCallback Method to get called on download complete
+     * @param progressCallback Method to get called with the received/total bytes
+     */
+    static void download(const QUrl& controlUrl, const QString& seedPath, const QString& filePath,
+                         std::function<void(bool)> finishedCallback = nullptr,
+                         std::function<void(qint64, qint64)> progressCallback = nullptr);
+
+private:
+    using Range = QPair<qint64, qint64>;
+
+    explicit ZsyncUtil(const QUrl& controlUrl, const QString& seedPath, const QString& filePath,
+                       std::function<void(bool)> finishedCallback,
+                       std::function<void(qint64, qint64)> progressCallback,
+                       QObject* parent = nullptr);
+
+    static const int maxRangesPerRequest;
+    static const qint64 maxBytesPerRequest;
+
+    const QUrl m_controlUrl;
+    const QString m_seedPath;
+    const QString m_filePath;
+    std::function<void(bool)> m_finishedCallback;
+    std::function<void(qint64, qint64)> m_progressCallback;
+    ZsyncControl m_control;
+    QList<Range> m_missing;
+    qint64 m_reused = 0;
+    qint64 m_downloaded = 0;
+    bool m_fellBack = false;
+
+    void start();
+    void onControlFinished(QNetworkReply* reply);
+    void onMatchFinished(const QList<Range>& missing);
+    void fetchNextRanges();
+    void onRangesFinished(QNetworkReply* reply, const QList<Range>& ranges);
+    void verify();
+    void fallback();
+    void finish(bool success);
+    void reportProgress();
+
+    static const QList<Range> matchBlocks(const ZsyncControl& control, const QString& seedPath, const QString& filePath, qint64& reused);
+    static const bool writeRanges(QNetworkReply* reply, const QByteArray& body, const QList<Range>& ranges, const QString& filePath);
+    static const bool verifyFile(const ZsyncControl& control, const QString& filePath);
+};
+
+#endif // ZSYNCUTIL_H